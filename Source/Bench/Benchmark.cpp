@@ -0,0 +1,172 @@
+#include "Benchmark.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+#include <thread>
+#include <utility>
+
+namespace
+{
+  // bump whenever the JSON's layout changes
+  constexpr int JSON_FORMAT = 1;
+
+  // iterations at most grow this much between calibration runs
+  constexpr double MAX_GROWTH = 10;
+
+  std::string buildName()
+  {
+#if defined(__clang__)
+    std::string build = "clang " __clang_version__;
+#elif defined(__GNUC__)
+    std::string build = "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    std::string build = "msvc " + std::to_string(_MSC_VER);
+#else
+    std::string build = "unknown compiler";
+#endif
+
+#ifdef NDEBUG
+    build += ", release";
+#else
+    build += ", debug";
+#endif
+    return build;
+  }
+
+  void writeNumber(std::ostream& out, const char* key, double value)
+  {
+    char text[64];
+    std::snprintf(text, sizeof(text), "\"%s\": %.3f", key, value);
+    out << text;
+  }
+}
+
+Benchmark::Benchmark(Options options_) : options(std::move(options_)) {}
+
+/**
+ *   @brief   Gets the warm up time
+ *   @return  The time to run a benchmark for before timing it.
+ */
+Benchmark::clock::duration Benchmark::warmup() const
+{
+  return std::chrono::duration_cast<clock::duration>(
+    std::chrono::duration<double, std::milli>(options.warmup_ms));
+}
+
+/**
+ *   @brief   Picks the iterations for the next calibration run
+ *   @details Aims a little past the minimum time, so the next run is
+ *            likely the last, but never grows by more than tenfold
+ *            in case the last run was too quick to time.
+ *   @return  The iterations to try next.
+ */
+std::uint64_t Benchmark::nextIterations(std::uint64_t iterations,
+                                        double ns) const
+{
+  double wanted = options.min_time_ms * 1e6 * 1.2;
+  double growth = ns > 0 ? wanted / ns : MAX_GROWTH;
+  growth = std::min(MAX_GROWTH, std::max(2.0, growth));
+  return static_cast<std::uint64_t>(std::ceil(double(iterations) * growth));
+}
+
+/**
+ *   @brief   Summarises the repetitions of a benchmark
+ *   @details The standard deviation is of the sample, as the
+ *            repetitions are a sample of every run that could be made.
+ *   @return  The benchmark's statistics.
+ */
+BenchStats Benchmark::summarise(const std::string& name,
+                                std::size_t items,
+                                std::uint64_t iterations,
+                                std::vector<double> samples)
+{
+  BenchStats stats;
+  stats.name = name;
+  stats.items = items;
+  stats.iterations = iterations;
+  stats.samples = samples;
+  if (samples.empty())
+  {
+    return stats;
+  }
+
+  std::sort(samples.begin(), samples.end());
+  std::size_t count = samples.size();
+  stats.min = samples.front();
+  stats.max = samples.back();
+  stats.median = count % 2 == 1
+                   ? samples[count / 2]
+                   : (samples[count / 2 - 1] + samples[count / 2]) / 2;
+  stats.mean =
+    std::accumulate(samples.begin(), samples.end(), 0.0) / double(count);
+
+  if (count > 1)
+  {
+    double squares = 0;
+    for (double sample : samples)
+    {
+      squares += (sample - stats.mean) * (sample - stats.mean);
+    }
+    stats.stddev = std::sqrt(squares / double(count - 1));
+  }
+
+  return stats;
+}
+
+/**
+ *   @brief   Writes every result as JSON
+ *   @details Times are nanoseconds per item, to three decimal places.
+ *   @return  void
+ */
+void Benchmark::writeJson(std::ostream& out) const
+{
+  out << "{\n";
+  out << "  \"format\": " << JSON_FORMAT << ",\n";
+  out << "  \"build\": \"" << buildName() << "\",\n";
+  out << "  \"hardware_threads\": " << std::thread::hardware_concurrency()
+      << ",\n";
+  out << "  \"settings\": { ";
+  writeNumber(out, "warmup_ms", options.warmup_ms);
+  out << ", ";
+  writeNumber(out, "min_time_ms", options.min_time_ms);
+  out << ", \"repetitions\": " << options.repetitions << " },\n";
+  out << "  \"benchmarks\": [";
+
+  for (std::size_t i = 0; i < results.size(); ++i)
+  {
+    const BenchStats& stats = results[i];
+    out << (i == 0 ? "\n" : ",\n");
+    out << "    {\n";
+    out << "      \"name\": \"" << stats.name << "\",\n";
+    out << "      \"items\": " << stats.items << ",\n";
+    out << "      \"iterations\": " << stats.iterations << ",\n";
+    out << "      \"ns_per_item\": { ";
+    writeNumber(out, "mean", stats.mean);
+    out << ", ";
+    writeNumber(out, "median", stats.median);
+    out << ", ";
+    writeNumber(out, "stddev", stats.stddev);
+    out << ", ";
+    writeNumber(out, "min", stats.min);
+    out << ", ";
+    writeNumber(out, "max", stats.max);
+    out << " },\n";
+
+    char cv[32];
+    std::snprintf(cv, sizeof(cv), "%.4f", stats.cv());
+    out << "      \"cv\": " << cv << ",\n";
+    out << "      \"samples\": [";
+    for (std::size_t j = 0; j < stats.samples.size(); ++j)
+    {
+      char sample[32];
+      std::snprintf(sample, sizeof(sample), "%.3f", stats.samples[j]);
+      out << (j == 0 ? "" : ", ") << sample;
+    }
+    out << "]\n";
+    out << "    }";
+  }
+
+  out << (results.empty() ? "]\n" : "\n  ]\n");
+  out << "}\n";
+}
@@ -0,0 +1,144 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ *  The repetitions of one benchmark, in nanoseconds per item.
+ */
+struct BenchStats
+{
+  std::string name;
+  std::size_t items = 0;        /**< Items processed per iteration. */
+  std::uint64_t iterations = 0; /**< Iterations in each repetition. */
+  std::vector<double> samples;  /**< One per repetition. */
+  double mean = 0;
+  double median = 0;
+  double stddev = 0;
+  double min = 0;
+  double max = 0;
+
+  /**
+   *  Gets the spread of the repetitions relative to their mean.
+   *  @return the coefficient of variation, or 0 for no spread
+   */
+  double cv() const { return mean > 0 ? stddev / mean : 0; }
+};
+
+/**
+ *  Times small pieces of code and reports them as JSON.
+ *  A benchmark's body is given a number of iterations to run. It is
+ *  first run with more and more iterations until one run takes the
+ *  minimum time, then run again until the warm up time has passed so
+ *  caches, branch predictors and the clock speed settle, and only then
+ *  timed over each repetition. Reporting the spread of the repetitions
+ *  alongside their mean and median shows how far a difference between
+ *  two runs can be trusted.
+ */
+class Benchmark
+{
+ public:
+  using clock = std::chrono::steady_clock;
+
+  struct Options
+  {
+    double warmup_ms = 100;
+    double min_time_ms = 50; /**< Shortest run of a repetition. */
+    int repetitions = 10;
+    std::string filter; /**< Only names containing this are run. */
+  };
+
+  /**
+   *  Constructor.
+   *  @param [in] options How long and how often to run each benchmark
+   */
+  explicit Benchmark(Options options);
+
+  /**
+   *  Runs a benchmark, unless it is filtered out.
+   *  @param [in] name The benchmark's name, unique within the run
+   *  @param [in] items The items the body processes each iteration, so
+   *  benchmarks of different sizes are reported per item
+   *  @param [in] body Called as body(iterations)
+   */
+  template<typename Body>
+  void run(const std::string& name, std::size_t items, Body&& body)
+  {
+    if (!options.filter.empty() && name.find(options.filter) == name.npos)
+    {
+      return;
+    }
+
+    clock::time_point started = clock::now();
+    std::uint64_t iterations = 1;
+    double elapsed = time(body, iterations);
+    while (elapsed < options.min_time_ms * 1e6)
+    {
+      iterations = nextIterations(iterations, elapsed);
+      elapsed = time(body, iterations);
+    }
+
+    while (clock::now() - started < warmup())
+    {
+      time(body, iterations);
+    }
+
+    std::vector<double> samples;
+    for (int i = 0; i < options.repetitions; ++i)
+    {
+      samples.push_back(time(body, iterations) / double(iterations) /
+                        double(items > 0 ? items : 1));
+    }
+
+    results.push_back(summarise(name, items, iterations, samples));
+  }
+
+  /**
+   *  Writes every result as JSON.
+   *  Keys are always written in the same order, so the output of two
+   *  runs can be compared line by line.
+   *  @param [in] out The stream to write to
+   */
+  void writeJson(std::ostream& out) const;
+
+  /**
+   *  Stops the compiler from optimising a value away.
+   *  @param [in] value A result the benchmark would otherwise discard
+   */
+  template<typename T>
+  static void keep(const T& value)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    sink = &value;
+#endif
+  }
+
+ private:
+  template<typename Body>
+  static double time(Body& body, std::uint64_t iterations)
+  {
+    clock::time_point start = clock::now();
+    body(iterations);
+    return std::chrono::duration<double, std::nano>(clock::now() - start)
+      .count();
+  }
+
+  clock::duration warmup() const;
+  std::uint64_t nextIterations(std::uint64_t iterations, double ns) const;
+  static BenchStats summarise(const std::string& name,
+                              std::size_t items,
+                              std::uint64_t iterations,
+                              std::vector<double> samples);
+
+  Options options;
+  std::vector<BenchStats> results;
+
+#if !defined(__GNUC__) && !defined(__clang__)
+  static inline const void* volatile sink = nullptr;
+#endif
+};
@@ -0,0 +1,137 @@
+#pragma once
+#include <Engine/Font.h>
+#include <Engine/Gamepad.h>
+#include <Engine/Input.h>
+#include <Engine/Renderer.h>
+#include <Engine/Sprite.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+/**
+ *  A sprite with no texture, so it can be created without a GPU.
+ *  Only its position, size and the other plain state are usable.
+ *  Loading a texture only succeeds for files whose size it was given,
+ *  and sizes the sprite to match, as a real texture would.
+ */
+class HeadlessSprite : public ASGE::Sprite
+{
+ public:
+  using Sizes = std::map<std::string, std::pair<float, float>>;
+
+  explicit HeadlessSprite(const Sizes* sizes = nullptr) : sizes(sizes) {}
+
+  bool loadTexture(const std::string& file) override
+  {
+    if (sizes == nullptr)
+    {
+      return false;
+    }
+
+    auto size = sizes->find(file);
+    if (size == sizes->end())
+    {
+      return false;
+    }
+
+    width(size->second.first);
+    height(size->second.second);
+    return true;
+  }
+
+  const ASGE::Texture2D* getTexture() const override { return nullptr; }
+
+ private:
+  const Sizes* sizes;
+};
+
+/**
+ *  Input that only ever comes from events sent to it directly.
+ */
+class HeadlessInput : public ASGE::Input
+{
+ public:
+  bool init(ASGE::Renderer*) override { return true; }
+  void update() override {}
+  void getCursorPos(double& xpos, double& ypos) const override
+  {
+    xpos = 0;
+    ypos = 0;
+  }
+  void setCursorMode(ASGE::MOUSE::CursorMode) override {}
+  const ASGE::GamePadData getGamePad(int idx) const override
+  {
+    return ASGE::GamePadData(idx, "", 0, nullptr, 0, nullptr);
+  }
+};
+
+/**
+ *  A renderer that creates headless sprites and draws nothing.
+ *  Lets the game and its components be built and timed without a
+ *  window or GL context. Loading fonts always fails, and textures only
+ *  load if their size has been added.
+ */
+class HeadlessRenderer : public ASGE::Renderer
+{
+ public:
+  HeadlessRenderer() : ASGE::Renderer(RenderLib::INVALID) {}
+
+  /**
+   *  Lets sprites load a texture.
+   *  @param [in] file The texture's path, as the game loads it
+   *  @param [in] width The texture's width in pixels
+   *  @param [in] height The texture's height in pixels
+   */
+  void addTexture(const std::string& file, float width, float height)
+  {
+    textures[file] = { width, height };
+  }
+
+  void setClearColour(ASGE::Colour) override {}
+  int loadFont(const char*, int) override { return -1; }
+  int loadFontFromMem(const char*, const unsigned char*, unsigned int, int)
+    override
+  {
+    return -1;
+  }
+  bool init(int, int, WindowMode) override { return true; }
+  bool exit() override { return true; }
+  void preRender() override {}
+  void postRender() override {}
+  void renderText(const std::string,
+                  int,
+                  int,
+                  float,
+                  const ASGE::Colour&,
+                  float) override
+  {
+  }
+  void setDefaultTextColour(const ASGE::Colour&) override {}
+  ASGE::SHADER_LIB::Shader* findShader(int) override { return nullptr; }
+  const ASGE::Font& getActiveFont() const override { return font; }
+  void setFont(int) override {}
+  void renderSprite(const ASGE::Sprite&, float) override {}
+  void setSpriteMode(ASGE::SpriteSortMode) override {}
+  void setWindowedMode(WindowMode) override {}
+  void setWindowTitle(const char*) override {}
+  void swapBuffers() override {}
+  std::unique_ptr<ASGE::Input> inputPtr() override
+  {
+    return std::make_unique<HeadlessInput>();
+  }
+  std::unique_ptr<ASGE::Sprite> createUniqueSprite() override
+  {
+    return std::make_unique<HeadlessSprite>(&textures);
+  }
+  ASGE::Sprite* createRawSprite() override
+  {
+    return new HeadlessSprite(&textures);
+  }
+  int initPixelShader(std::string) override { return -1; }
+  void setActiveShader(ASGE::SHADER_LIB::Shader*) override {}
+
+ private:
+  ASGE::Font font;
+  HeadlessSprite::Sizes textures;
+};
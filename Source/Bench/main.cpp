@@ -0,0 +1,387 @@
+#include "Bench/Benchmark.h"
+#include "Bench/HeadlessRenderer.h"
+#include "Components/GameObject.h"
+#include "Simulation/GameRules.h"
+#include "Systems/Broadphase.h"
+#include "Systems/JobSystem.h"
+#include "Utility/Rect.h"
+#include "Utility/Vector2.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+  constexpr std::size_t SHAPES = 1024;
+  constexpr std::size_t COLUMNS = 9; /**< Aliens across the screen. */
+  constexpr std::uint32_t SEED = 1;
+  constexpr double FRAME_MS = 1000.0 / 60.0;
+
+  /**
+   *  A float from a generator whose output is the same everywhere,
+   *  unlike the standard distributions.
+   */
+  float between(std::mt19937& random, float min, float max)
+  {
+    return min + (max - min) * float(random() % 10000) / 10000.f;
+  }
+
+  std::vector<rect> randomRects(std::mt19937& random, std::size_t count)
+  {
+    std::vector<rect> rects(count);
+    for (rect& shape : rects)
+    {
+      shape.x = between(random, 0, 200);
+      shape.y = between(random, 0, 200);
+      shape.length = between(random, 10, 80);
+      shape.height = between(random, 10, 80);
+    }
+    return rects;
+  }
+
+  /**
+   *  A wave of aliens and the ship's lasers, laid out as the game lays
+   *  them out, with sprites that have no textures.
+   */
+  struct Wave
+  {
+    Wave(ASGE::Renderer& renderer, std::size_t alien_count, int laser_count) :
+      aliens(alien_count),
+      lasers(static_cast<std::size_t>(laser_count)),
+      sine(alien_count, vector2(0, 0))
+    {
+      HeadlessSprite alien;
+      alien.width(GameRules::ALIEN_SIZE);
+      alien.height(GameRules::ALIEN_SIZE);
+      for (GameObject& object : aliens)
+      {
+        object.addSpriteComponent(&renderer, alien);
+        object.visibility = true;
+      }
+      reset();
+
+      // lasers are scattered over the wave, so some hit and some miss
+      HeadlessSprite laser;
+      laser.width(GameRules::LASER_WIDTH);
+      laser.height(GameRules::LASER_HEIGHT);
+      std::mt19937 random(SEED);
+      for (GameObject& object : lasers)
+      {
+        object.addSpriteComponent(&renderer, laser);
+        ASGE::Sprite* sprite = object.spriteComponent()->getSprite();
+        sprite->xPos(between(random, 0, width() - GameRules::LASER_WIDTH));
+        sprite->yPos(between(random, GameRules::WAVE_TOP, height()));
+      }
+    }
+
+    void reset()
+    {
+      for (std::size_t i = 0; i < aliens.size(); ++i)
+      {
+        ASGE::Sprite* sprite = aliens[i].spriteComponent()->getSprite();
+        sprite->xPos(float(i % COLUMNS) * GameRules::ALIEN_SIZE);
+        sprite->yPos(GameRules::WAVE_TOP +
+                     float(i / COLUMNS) * GameRules::ALIEN_SIZE);
+      }
+    }
+
+    float width() const { return float(COLUMNS) * GameRules::ALIEN_SIZE; }
+
+    float height() const
+    {
+      float rows = float((aliens.size() + COLUMNS - 1) / COLUMNS);
+      return GameRules::WAVE_TOP + rows * GameRules::ALIEN_SIZE;
+    }
+
+    std::vector<GameObject> aliens;
+    std::vector<GameObject> lasers;
+    std::vector<vector2> sine;
+  };
+
+  void benchRects(Benchmark& bench)
+  {
+    std::mt19937 random(SEED);
+    std::vector<rect> lhs = randomRects(random, SHAPES);
+    std::vector<rect> rhs = randomRects(random, SHAPES);
+
+    bench.run("rect/overlap/scalar", 1, [&](std::uint64_t iterations) {
+      for (std::uint64_t i = 0; i < iterations; ++i)
+      {
+        std::size_t pair = i % SHAPES;
+        Benchmark::keep(lhs[pair].isInside(rhs[pair]));
+      }
+    });
+
+    bench.run("rect/point/scalar", 1, [&](std::uint64_t iterations) {
+      for (std::uint64_t i = 0; i < iterations; ++i)
+      {
+        const rect& point = rhs[i % SHAPES];
+        Benchmark::keep(lhs[i % SHAPES].isInside(point.x, point.y));
+      }
+    });
+
+    for (std::size_t count : { 64u, 1024u, 16384u })
+    {
+      std::vector<rect> targets = randomRects(random, count);
+      rect laser{ 100, 100, GameRules::LASER_WIDTH, GameRules::LASER_HEIGHT };
+
+      bench.run("rect/overlap/batch/" + std::to_string(count),
+                count,
+                [&](std::uint64_t iterations) {
+                  for (std::uint64_t i = 0; i < iterations; ++i)
+                  {
+                    std::size_t hits = 0;
+                    for (const rect& target : targets)
+                    {
+                      hits += laser.isInside(target) ? 1 : 0;
+                    }
+                    Benchmark::keep(hits);
+                  }
+                });
+    }
+  }
+
+  void benchVectors(Benchmark& bench)
+  {
+    std::mt19937 random(SEED);
+    std::vector<vector2> vectors(SHAPES, vector2(0, 0));
+    for (vector2& vector : vectors)
+    {
+      vector = vector2(between(random, -100, 100), between(random, -100, 100));
+    }
+
+    bench.run("vector2/normalise", SHAPES, [&](std::uint64_t iterations) {
+      for (std::uint64_t i = 0; i < iterations; ++i)
+      {
+        for (const vector2& vector : vectors)
+        {
+          vector2 unit(vector);
+          unit.normalise();
+          Benchmark::keep(unit);
+        }
+      }
+    });
+
+    bench.run("vector2/scale", SHAPES, [&](std::uint64_t iterations) {
+      for (std::uint64_t i = 0; i < iterations; ++i)
+      {
+        for (vector2& vector : vectors)
+        {
+          Benchmark::keep(vector * 1.5f);
+        }
+      }
+    });
+  }
+
+  void benchBoundingBoxes(Benchmark& bench, ASGE::Renderer& renderer)
+  {
+    Wave wave(renderer, SHAPES, 0);
+
+    bench.run("sprite/bounding_box", SHAPES, [&](std::uint64_t iterations) {
+      for (std::uint64_t i = 0; i < iterations; ++i)
+      {
+        for (GameObject& alien : wave.aliens)
+        {
+          Benchmark::keep(alien.spriteComponent()->getBoundingBox());
+        }
+      }
+    });
+  }
+
+  /**
+   *  Tests every laser against the wave, as the game does, both
+   *  against every alien and against the aliens the grid suggests.
+   *  Each is reported per entity, so the two scale alike.
+   */
+  void benchCollisions(Benchmark& bench, ASGE::Renderer& renderer)
+  {
+    JobSystem jobs(0);
+    Broadphase grid(128, GameRules::ALIEN_SIZE);
+
+    for (std::size_t aliens : { 7u, 1000u, 10000u, 100000u })
+    {
+      for (int lasers : { 3, 64 })
+      {
+        Wave wave(renderer, aliens, lasers);
+        std::size_t entities = aliens + static_cast<std::size_t>(lasers);
+        std::string size =
+          std::to_string(aliens) + "x" + std::to_string(lasers);
+
+        bench.run("collision/all/" + size,
+                  entities,
+                  [&](std::uint64_t iterations) {
+                    for (std::uint64_t i = 0; i < iterations; ++i)
+                    {
+                      for (GameObject& laser : wave.lasers)
+                      {
+                        rect bounds =
+                          laser.spriteComponent()->getBoundingBox();
+                        std::size_t hit = wave.aliens.size();
+                        for (std::size_t j = 0; j < hit; ++j)
+                        {
+                          GameObject& alien = wave.aliens[j];
+                          if (alien.visibility &&
+                              bounds.isInside(
+                                alien.spriteComponent()->getBoundingBox()))
+                          {
+                            hit = j;
+                          }
+                        }
+                        Benchmark::keep(hit);
+                      }
+                    }
+                  });
+
+        rect world;
+        world.length = wave.width();
+        world.height = wave.height();
+        auto bounds_of = [&](std::size_t j, rect& out) {
+          out = wave.aliens[j].spriteComponent()->getBoundingBox();
+          return wave.aliens[j].visibility;
+        };
+
+        bench.run("collision/grid/" + size,
+                  entities,
+                  [&](std::uint64_t iterations) {
+                    for (std::uint64_t i = 0; i < iterations; ++i)
+                    {
+                      grid.build(jobs, world, wave.aliens.size(), bounds_of);
+                      for (GameObject& laser : wave.lasers)
+                      {
+                        rect bounds =
+                          laser.spriteComponent()->getBoundingBox();
+                        std::size_t hit = wave.aliens.size();
+                        grid.query(bounds, [&](std::size_t j) {
+                          GameObject& alien = wave.aliens[j];
+                          if (j < hit && alien.visibility &&
+                              bounds.isInside(
+                                alien.spriteComponent()->getBoundingBox()))
+                          {
+                            hit = j;
+                          }
+                        });
+                        Benchmark::keep(hit);
+                      }
+                    }
+                  });
+      }
+    }
+  }
+
+  /**
+   *  Moves the wave one frame at a time, as the game moves each alien.
+   *  The wave is put back every so often, as some modes accelerate it
+   *  off towards infinity.
+   */
+  void benchAlienMovement(Benchmark& bench, ASGE::Renderer& renderer)
+  {
+    for (std::size_t aliens : { 7u, 1000u, 100000u })
+    {
+      Wave wave(renderer, aliens, 0);
+      for (int mode = 1; mode <= 4; ++mode)
+      {
+        GameRules::AlienStep step;
+        step.mode = mode;
+        step.delta_time = FRAME_MS;
+        step.world_width = wave.width();
+
+        bench.run("alien_movement/mode" + std::to_string(mode) + "/" +
+                    std::to_string(aliens),
+                  aliens,
+                  [&](std::uint64_t iterations) {
+                    wave.reset();
+                    for (std::uint64_t i = 0; i < iterations; ++i)
+                    {
+                      if (i % 1024 == 1023)
+                      {
+                        wave.reset();
+                      }
+
+                      step.direction = i % 2 == 0 ? 1.f : -1.f;
+                      for (std::size_t j = 0; j < aliens; ++j)
+                      {
+                        ASGE::Sprite* sprite =
+                          wave.aliens[j].spriteComponent()->getSprite();
+                        float x_pos = sprite->xPos();
+                        float y_pos = sprite->yPos();
+
+                        wave.sine[j].normalise();
+                        GameRules::moveAlien(step,
+                                             x_pos,
+                                             y_pos,
+                                             sprite->width(),
+                                             sprite->height(),
+                                             wave.sine[j].x);
+
+                        sprite->xPos(x_pos);
+                        sprite->yPos(y_pos);
+                      }
+                    }
+                  });
+      }
+    }
+  }
+}
+
+/**
+ *   @brief   Runs the microbenchmarks
+ *   @details Supported options:
+ *            --out PATH        writes the JSON to PATH, not stdout
+ *            --filter TEXT     only runs benchmarks named with TEXT
+ *            --repetitions N   times each benchmark N times
+ *            --min-time MS     each repetition runs for at least MS
+ *            --warmup MS       runs each benchmark for MS untimed
+ *   @return  0 once every benchmark has run.
+ */
+int main(int argc, char* argv[])
+{
+  Benchmark::Options options;
+  std::string out_file;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg == "--out" && i + 1 < argc)
+    {
+      out_file = argv[++i];
+    }
+    else if (arg == "--filter" && i + 1 < argc)
+    {
+      options.filter = argv[++i];
+    }
+    else if (arg == "--repetitions" && i + 1 < argc)
+    {
+      options.repetitions = std::max(1, std::atoi(argv[++i]));
+    }
+    else if (arg == "--min-time" && i + 1 < argc)
+    {
+      options.min_time_ms = std::max(0.01, std::atof(argv[++i]));
+    }
+    else if (arg == "--warmup" && i + 1 < argc)
+    {
+      options.warmup_ms = std::max(0.0, std::atof(argv[++i]));
+    }
+  }
+
+  Benchmark bench(options);
+  HeadlessRenderer renderer;
+  benchRects(bench);
+  benchVectors(bench);
+  benchBoundingBoxes(bench, renderer);
+  benchCollisions(bench, renderer);
+  benchAlienMovement(bench, renderer);
+
+  if (out_file.empty())
+  {
+    bench.writeJson(std::cout);
+    return 0;
+  }
+
+  std::ofstream out(out_file);
+  bench.writeJson(out);
+  return out ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+#include "Systems/AsyncLogger.h"
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+  constexpr int CLICKS = 4 * AsyncLogger::MAX_THREADS;
+  constexpr const char* LOG_FILE = "async_logger_check.log";
+
+  /**
+   *  Logs a click from a new thread, as the engine's input does.
+   */
+  std::future<void> click(int i)
+  {
+    return std::async(std::launch::async, [i]() {
+      AsyncLogger::log("Click at x_pos: {}, y_pos: {}", double(i), 0.0);
+    });
+  }
+}
+
+/**
+ *   @brief   Checks no click is lost however many threads log them
+ *   @details Clicks are logged both one thread after another, so rings
+ *            must be reused, and all at once, so threads must share.
+ *   @return  0 if every click was written out and none was dropped.
+ */
+int main()
+{
+  std::remove(LOG_FILE);
+  if (!AsyncLogger::start(LOG_FILE))
+  {
+    std::cerr << "Couldn't open " << LOG_FILE << std::endl;
+    return 1;
+  }
+
+  for (int i = 0; i < CLICKS; ++i)
+  {
+    click(i).wait();
+  }
+
+  std::vector<std::future<void>> together;
+  for (int i = 0; i < CLICKS; ++i)
+  {
+    together.push_back(click(i));
+  }
+  for (std::future<void>& clicked : together)
+  {
+    clicked.wait();
+  }
+
+  AsyncLogger::stop();
+
+  std::ifstream log(LOG_FILE);
+  std::string line;
+  int clicks = 0;
+  int dropped = 0;
+  while (std::getline(log, line))
+  {
+    clicks += line.find("Click at") != std::string::npos ? 1 : 0;
+    dropped += line.find("dropped") != std::string::npos ? 1 : 0;
+  }
+
+  if (clicks != 2 * CLICKS || dropped > 0)
+  {
+    std::cerr << "Logged " << clicks << " of " << 2 * CLICKS
+              << " clicks, with " << dropped << " drops" << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
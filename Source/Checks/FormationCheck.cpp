@@ -0,0 +1,156 @@
+#include "Simulation/GameRules.h"
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+  constexpr double FRAME_MS = 1000.0 / 60.0;
+  constexpr int FRAMES = 3000;
+
+  /**
+   *  A row of the wave, moved as the game moves its rows.
+   *  Every alien in a row moves alike, so only its bounds are kept.
+   */
+  struct Row
+  {
+    float x = 0;
+    float length = 0;
+    bool full_rate = false; /**< Near the action, so never skipped. */
+    double pending = 0;
+  };
+
+  /**
+   *  The reviewer's case: a distant, full top row and a near bottom
+   *  row with its edge columns shot away.
+   */
+  std::vector<Row> wave()
+  {
+    std::vector<Row> rows(2);
+    rows[0].length = 7 * GameRules::ALIEN_SIZE;
+    rows[1].x = 2 * GameRules::ALIEN_SIZE;
+    rows[1].length = 3 * GameRules::ALIEN_SIZE;
+    rows[1].full_rate = true;
+    return rows;
+  }
+
+  struct Played
+  {
+    std::vector<int> turns; /**< Frames the wave turned on. */
+    std::vector<float> x;   /**< Where each row ends up at full rate. */
+  };
+
+  /**
+   *  Plays the wave in the first movement mode, moving distant rows
+   *  only every lod_interval frames as alienMovement does.
+   */
+  Played play(std::uint32_t lod_interval)
+  {
+    std::vector<Row> rows = wave();
+    GameRules::AlienStep step;
+    step.mode = 1;
+    Played played;
+
+    for (int frame = 0; frame < FRAMES; ++frame)
+    {
+      step.advance = true;
+      bool edge_reached = false;
+      for (const Row& row : rows)
+      {
+        if (GameRules::rowAtEdge(step, row.x, row.length, row.pending))
+        {
+          edge_reached = true;
+        }
+      }
+
+      if (edge_reached)
+      {
+        for (Row& row : rows)
+        {
+          row.x += GameRules::alienAdvance(step.direction, row.pending);
+          row.pending = 0;
+        }
+        step.direction = -step.direction;
+        played.turns.push_back(frame);
+      }
+
+      step.advance = !edge_reached;
+      for (std::size_t i = 0; i < rows.size(); ++i)
+      {
+        Row& row = rows[i];
+        bool due = edge_reached || row.full_rate ||
+                   (i + std::size_t(frame)) % lod_interval == 0;
+        if (!due)
+        {
+          row.pending += FRAME_MS;
+          continue;
+        }
+
+        if (step.advance)
+        {
+          row.x += GameRules::alienAdvance(step.direction,
+                                           FRAME_MS + row.pending);
+        }
+        row.pending = 0;
+      }
+    }
+
+    for (const Row& row : rows)
+    {
+      played.x.push_back(
+        row.x + GameRules::alienAdvance(step.direction, row.pending));
+    }
+    return played;
+  }
+}
+
+/**
+ *   @brief   Checks distant rows moving less often never move the turn
+ *   @details The wave is played at full rate and at each rate the
+ *            governor can shed to, and must turn on the same frames
+ *            and end up in the same place.
+ *   @return  0 if every rate matches full rate.
+ */
+int main()
+{
+  Played full = play(1);
+  if (full.turns.size() < 2)
+  {
+    std::cerr << "The wave only turned " << full.turns.size() << " times"
+              << std::endl;
+    return 1;
+  }
+
+  int failures = 0;
+  for (std::uint32_t interval : { 4u, 16u })
+  {
+    Played reduced = play(interval);
+    if (reduced.turns != full.turns)
+    {
+      std::size_t i = 0;
+      while (i < reduced.turns.size() && i < full.turns.size() &&
+             reduced.turns[i] == full.turns[i])
+      {
+        ++i;
+      }
+      std::cerr << "Moving distant rows every " << interval
+                << " frames changed turn " << i << " of "
+                << full.turns.size() << std::endl;
+      ++failures;
+    }
+
+    for (std::size_t row = 0; row < full.x.size(); ++row)
+    {
+      if (std::abs(reduced.x[row] - full.x[row]) > 0.01f)
+      {
+        std::cerr << "Moving distant rows every " << interval
+                  << " frames left row " << row << " at " << reduced.x[row]
+                  << " rather than " << full.x[row] << std::endl;
+        ++failures;
+      }
+    }
+  }
+
+  return failures == 0 ? 0 : 1;
+}
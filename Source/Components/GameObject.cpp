@@ -21,6 +21,21 @@ bool GameObject::addSpriteComponent(ASGE::Renderer* renderer,
   return false;
 }
 
+bool GameObject::addSpriteComponent(ASGE::Renderer* renderer,
+                                    const ASGE::Sprite& stamp)
+{
+  free();
+
+  sprite_component = new SpriteComponent();
+  if (sprite_component->loadSprite(renderer, stamp))
+  {
+    return true;
+  }
+
+  free();
+  return false;
+}
+
 void GameObject::free()
 {
   delete sprite_component;
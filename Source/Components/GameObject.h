@@ -31,6 +31,9 @@ class GameObject
    */
   ~GameObject();
 
+  GameObject(const GameObject&) = delete;
+  GameObject& operator=(const GameObject&) = delete;
+
   /**
    *  Allocates and attaches a sprite component to the object.
    *  Part of this process will attempt to load a texture file.
@@ -43,6 +46,16 @@ class GameObject
   bool addSpriteComponent(ASGE::Renderer* renderer,
                           const std::string& texture_file_name);
 
+  /**
+   *  Allocates and attaches a sprite component sized like a stamp.
+   *  The stamp's texture isn't loaded again, so the object's sprite
+   *  is only used for its position and size.
+   *  @param [in] renderer The renderer used to perform the allocations
+   *  @param [in] stamp The loaded sprite to copy the size of
+   *  @return true if the component is successfully added
+   */
+  bool addSpriteComponent(ASGE::Renderer* renderer, const ASGE::Sprite& stamp);
+
   /**
    *  Returns the sprite componenent.
    *  IT IS HIGHLY RECOMMENDED THAT YOU CHECK THE STATUS OF THE POINTER
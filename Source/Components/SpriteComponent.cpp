@@ -20,6 +20,16 @@ bool SpriteComponent::loadSprite(ASGE::Renderer* renderer,
   return false;
 }
 
+bool SpriteComponent::loadSprite(ASGE::Renderer* renderer,
+                                 const ASGE::Sprite& stamp)
+{
+  free();
+  sprite = renderer->createRawSprite();
+  sprite->width(stamp.width());
+  sprite->height(stamp.height());
+  return true;
+}
+
 void SpriteComponent::free()
 {
   if (sprite)
@@ -34,6 +34,17 @@ class SpriteComponent
   bool
   loadSprite(ASGE::Renderer* renderer, const std::string& texture_file_name);
 
+  /**
+   *  Allocates a sprite the same size as one already loaded.
+   *  No texture is loaded, so the sprite can only be positioned and
+   *  sized, not drawn. Used where the drawing is done by a shared
+   *  sprite that holds the texture.
+   *  @param [in] renderer The renderer used to perform the allocations
+   *  @param [in] stamp The loaded sprite to copy the size of
+   *  @return true if the sprite was successfully created
+   */
+  bool loadSprite(ASGE::Renderer* renderer, const ASGE::Sprite& stamp);
+
   /**
    *  Returns a pointer to the sprite residing in this component.
    *  As this is a pointer, you will need to check its contents before
@@ -1,6 +1,17 @@
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
 #include <string>
 
 #include "Game.h"
+#include "Systems/AllocationCounter.h"
+#include "Systems/AsyncLogger.h"
+#include "Systems/PerfCounters.h"
+#include "Systems/StartupProfiler.h"
 #include "Utility/Rect.h"
 #include "Utility/Vector2.h"
 #include "math.h"
@@ -15,9 +26,42 @@
  *   @details Consider setting the game's width and height
  *            and even seeding the random number generator.
  */
-SpaceInvadersGame::SpaceInvadersGame()
+SpaceInvadersGame::SpaceInvadersGame(const GameSettings& settings_) :
+  settings(settings_),
+  jobs(settings.workerThreads()),
+  render_list(jobs),
+  telemetry(settings.hitch_ms)
 {
   game_name = "Space Invaders: Gotta Pwn Them All";
+  frame_pacer.setTargetRate(settings.target_fps);
+  governor.setTargetRate(settings.target_fps);
+  idle_throttle.setTimeout(
+    std::chrono::milliseconds(settings.idle_timeout_ms));
+
+  Profiler::nameThread("main");
+  if (!settings.log_file.empty() && !AsyncLogger::start(settings.log_file))
+  {
+    ASGE::DebugPrinter{} << "Couldn't open the log " << settings.log_file
+                         << std::endl;
+  }
+
+  if (settings.trace_frames > 0)
+  {
+    Profiler::startTrace(settings.trace_frames, settings.trace_file);
+  }
+
+  if (settings.perf_counters && !PerfCounters::enable())
+  {
+    ASGE::DebugPrinter{} << "Hardware counters are unavailable, so they "
+                            "won't be collected"
+                         << std::endl;
+  }
+
+  if (!settings.metrics_name.empty() && !metrics.open(settings.metrics_name))
+  {
+    ASGE::DebugPrinter{} << "Couldn't create the metrics segment "
+                         << settings.metrics_name << std::endl;
+  }
 }
 
 /**
@@ -26,6 +70,9 @@ SpaceInvadersGame::SpaceInvadersGame()
  */
 SpaceInvadersGame::~SpaceInvadersGame()
 {
+  simulation.join();
+  Profiler::stopTrace();
+  AsyncLogger::stop();
   this->inputs->unregisterCallback(static_cast<unsigned int>(key_callback_id));
   this->inputs->unregisterCallback(
     static_cast<unsigned int>(mouse_callback_id));
@@ -36,12 +83,34 @@ SpaceInvadersGame::~SpaceInvadersGame()
  *   @details The game window is created and all assets required to
  *            run the game are loaded. The keyHandler and clickHandler
  *            callback should also be set in the initialise function.
+ *            The world doesn't need the window, so it is built on a
+ *            worker while the window and GL context are created.
  *   @return  True if the game initialised correctly.
  */
 bool SpaceInvadersGame::init()
 {
+  PROFILE_SCOPE("init");
   setupResolution();
-  if (!initAPI())
+
+  JobCounter world_built;
+  auto build_world = [this](std::size_t, std::size_t) {
+    StartupStage stage("world");
+    setupWorld();
+    setupAnimations();
+    setupFrameGraph();
+    setupGovernor();
+  };
+  jobs.schedule(world_built, 0, 1, 1, build_world);
+
+  bool opened = false;
+  {
+    StartupStage stage("window and GL");
+    opened = openWindow();
+  }
+
+  // the world must be finished with before returning, even on failure
+  jobs.wait(world_built);
+  if (!opened)
   {
     return false;
   }
@@ -49,107 +118,88 @@ bool SpaceInvadersGame::init()
   toggleFPS();
   renderer->setClearColour(ASGE::COLOURS::BLACK);
   renderer->setWindowTitle("Space Invaders!");
+  publishSnapshot();
 
-  // init game objects within a function to declutter (pass path, xpos, ypos)
-
-  // initate aliens within 2 for loops.
-
-  float last_position = 0;
-  float row = 100;
-
-  for (int i = 0; i < aliens_init; ++i)
+  if (!setupStamps() || !setupEntities())
   {
-    if (aliens[i].addSpriteComponent(renderer.get(),
-                                     "data/Textures/shipBlue.png"))
-    {
-      ASGE::Sprite* alienSprite = aliens[i].spriteComponent()->getSprite();
-      alienSprite->xPos(0 + last_position);
-      alienSprite->height(70);
-      alienSprite->width(70);
-      last_position = last_position + alienSprite->width();
-      alienSprite->yPos(row);
-      aliens[i].visibility = true;
-    }
-  }
-
-  if (ship.addSpriteComponent(renderer.get(),
-                              "data/Textures/playerShip1_red.png"))
-  {
-    ASGE::Sprite* shipSprite = ship.spriteComponent()->getSprite();
-    shipSprite->height(70);
-    shipSprite->width(70);
-    shipSprite->xPos((640 / 2.f) - (shipSprite->width() / 2.f));
-    shipSprite->yPos(700);
+    return false;
   }
 
-  for (int i = 0; i < shots_max; ++i)
-  {
-    if (ship_laser[i].addSpriteComponent(renderer.get(),
-                                         "data/Textures/laserRed01.png"))
-    {
-      ASGE::Sprite* laserSprite = ship_laser[i].spriteComponent()->getSprite();
-      laserSprite->xPos(ship.spriteComponent()->getSprite()->xPos());
-      laserSprite->yPos(ship.spriteComponent()->getSprite()->yPos());
+  // input handling functions
+  inputs->use_threads = true;
 
-      // init game objects within a function to declutter (pass path, xpos,
-      // ypos)
+  key_callback_id =
+    inputs->addCallbackFnc(ASGE::E_KEY, &SpaceInvadersGame::keyHandler, this);
 
-      // initate aliens within 2 for loops.
+  mouse_callback_id = inputs->addCallbackFnc(
+    ASGE::E_MOUSE_CLICK, &SpaceInvadersGame::clickHandler, this);
 
-      float last_position = 0;
-      float row = 100;
-
-      for (int i = 0; i < aliens_init; ++i)
-      {
-        if (aliens[i].addSpriteComponent(renderer.get(),
-                                         "data/Textures/shipBlue.png"))
-        {
-          ASGE::Sprite* alienSprite = aliens[i].spriteComponent()->getSprite();
-          alienSprite->xPos(0 + last_position);
-          alienSprite->height(70);
-          alienSprite->width(70);
-          last_position = last_position + alienSprite->width();
-          alienSprite->yPos(row);
-          aliens[i].visibility = true;
-        }
-      }
+  return true;
+}
 
-      if (ship.addSpriteComponent(renderer.get(),
-                                  "data/Textures/playerShip1_red.png"))
-      {
-        ASGE::Sprite* shipSprite = ship.spriteComponent()->getSprite();
-        shipSprite->height(70);
-        shipSprite->width(70);
-        shipSprite->xPos((640 / 2.f) - (shipSprite->width() / 2.f));
-        shipSprite->yPos(700);
-      }
+/**
+ *   @brief   Creates the window, GL context, renderer and input
+ *   @details Called once by init. Overridden to run the game without a
+ *            window, as the engine's initAPI can't be.
+ *   @return  True if the window opened.
+ */
+bool SpaceInvadersGame::openWindow()
+{
+  return initAPI();
+}
 
-      for (int i = 0; i < shots_max; ++i)
-      {
-        if (ship_laser[i].addSpriteComponent(renderer.get(),
-                                             "data/Textures/laserRed01.png"))
-        {
-          ASGE::Sprite* laserSprite =
-            ship_laser[i].spriteComponent()->getSprite();
-          laserSprite->xPos(float(ship.spriteComponent()->getSprite()->xPos()));
-          laserSprite->yPos(float(ship.spriteComponent()->getSprite()->yPos()));
+/**
+ *   @brief   Waits for the step kicked by the last update
+ *   @details Input queued afterwards is then certain to be applied by
+ *            the next step, rather than whichever one is running.
+ *   @return  void
+ */
+void SpaceInvadersGame::finishStep()
+{
+  simulation.join();
+}
 
-          ship_laser[i].visibility = false;
-        }
-      }
-      // input handling functions
-      inputs->use_threads = false;
+/**
+ *   @brief   Gets the frame pacing statistics
+ *   @details Jitter is measured against the target frame rate.
+ *   @return  The statistics gathered by the frame pacer.
+ */
+const PacingStats& SpaceInvadersGame::pacingStats() const
+{
+  return frame_pacer.stats();
+}
 
-      key_callback_id = inputs->addCallbackFnc(
-        ASGE::E_KEY, &SpaceInvadersGame::keyHandler, this);
+/**
+ *   @brief   Gets the input latency histograms
+ *   @details Only safe to read once the game has stopped running.
+ *   @return  The latency of input at each stage of the pipeline.
+ */
+const LatencyTracker& SpaceInvadersGame::inputLatency() const
+{
+  return latency;
+}
 
-      mouse_callback_id = inputs->addCallbackFnc(
-        ASGE::E_MOUSE_CLICK, &SpaceInvadersGame::clickHandler, this);
+/**
+ *   @brief   Gets the session's frame and phase time histograms
+ *   @details Only safe to read once the game has stopped running.
+ *   @return  The telemetry gathered this session.
+ */
+const SessionTelemetry& SpaceInvadersGame::sessionTelemetry() const
+{
+  return telemetry;
+}
 
-      return true;
-    }
-  }
+/**
+ *   @brief   Gets the frame that was drawn last
+ *   @details Only safe to read from the thread that renders, between
+ *            frames.
+ *   @return  The snapshot the last call to render drew.
+ */
+const FrameSnapshot& SpaceInvadersGame::drawnFrame() const
+{
+  return snapshots.readBuffer();
 }
+
 /**
  *   @brief   Sets the game window resolution
  *   @details This function is designed to create the window size, any
@@ -168,12 +218,246 @@ void SpaceInvadersGame::setupResolution()
   game_height = 920;
 }
 
+/**
+ *   @brief   Sizes the playfield
+ *   @details The playfield may be several screens tall, and always
+ *            grows to fit the whole alien wave with room for the ship
+ *            beneath it. The camera starts on the ship at the bottom.
+ *   @return  void
+ */
+void SpaceInvadersGame::setupWorld()
+{
+  alien_columns = std::min(settings.alien_columns, game_width / 70);
+  aliens_init = settings.alien_rows * alien_columns;
+  aliens_remaining = aliens_init;
+
+  aliens = std::vector<GameObject>(static_cast<std::size_t>(aliens_init));
+  alien_sine.assign(aliens.size(), vector2(0, 0));
+  row_bounds.assign(static_cast<std::size_t>(settings.alien_rows), rect());
+  row_pending.assign(row_bounds.size(), 0);
+  row_full_rate.assign(row_bounds.size(), 1);
+  row_dirty.assign(row_bounds.size(), 1);
+  laser_hits.assign(static_cast<std::size_t>(shots_max), aliens.size());
+
+  world_width = float(game_width);
+  world_height = std::max(float(settings.screens * game_height),
+                          float(settings.alien_rows * 70 + 460));
+
+  rect world;
+  world.length = world_width;
+  world.height = world_height;
+  camera = Camera(float(game_width), float(game_height));
+  camera.setWorldBounds(world);
+  camera.lookAt(world_width / 2, world_height);
+}
+
+/**
+ *   @brief   Defines the sprite-sheet animations
+ *   @details Frames are regions of the space ship sprite sheet. The
+ *            aliens cycle through the coloured ships, all of which
+ *            share one clock.
+ *   @return  void
+ */
+void SpaceInvadersGame::setupAnimations()
+{
+  int first = animator.addFrame({ 248, 325, 124, 90 }); // shipBlue
+  animator.addFrame({ 124, 403, 124, 68 });             // shipGreen
+  animator.addFrame({ 124, 72, 124, 72 });              // shipPink
+  animator.addFrame({ 0, 232, 124, 62 });               // shipYellow
+  animator.addFrame({ 372, 189, 124, 67 });             // shipBeige
+
+  alien_animation = animator.addAnimation(first, 5, 4);
+}
+
+/**
+ *   @brief   Builds the graph of tasks that updates a frame
+ *   @details Each phase of the update declares what it reads and
+ *            writes and which phases it follows. The aliens and
+ *            their broadphase grid update alongside the player's
+ *            ship and lasers, and the animation clocks alongside
+ *            everything. Debug builds refuse a graph where two
+ *            phases that may overlap share a resource.
+ *   @return  void
+ */
+void SpaceInvadersGame::setupFrameGraph()
+{
+  int input = frame_graph.addTask(
+    "input", INPUT, CAMERA, [this] { cameraMovement(step_time); });
+
+  int player = frame_graph.addTask(
+    "ship", 0, INPUT | SHIP, [this] { shipMovement(step_time); }, { input });
+
+  int wave = frame_graph.addTask("aliens",
+                                 FORMATION,
+                                 ALIENS | ROW_STATE,
+                                 [this] { alienMovement(step_time); });
+
+  int projectiles = frame_graph.addTask("projectiles",
+                                        SHIP,
+                                        INPUT | LASERS,
+                                        [this] { laserMovement(step_time); },
+                                        { player });
+
+  int broadphase = frame_graph.addTask(
+    "broadphase", ALIENS, GRID, [this] { buildBroadphase(); }, { wave });
+
+  int narrowphase = frame_graph.addTask("narrowphase",
+                                        SHIP | ALIENS | LASERS | GRID,
+                                        CONTACTS,
+                                        [this] { findCollisions(); },
+                                        { projectiles, broadphase });
+
+  int scoring = frame_graph.addTask("scoring",
+                                    CONTACTS | SHIP,
+                                    ALIENS | LASERS | SCORE | ROW_STATE,
+                                    [this] { applyCollisions(); },
+                                    { narrowphase });
+
+  int formation = frame_graph.addTask("formation",
+                                      CAMERA | SHIP | ALIENS | LASERS |
+                                      ROW_STATE,
+                                      FORMATION,
+                                      [this] { updateFormationBounds(); },
+                                      { scoring });
+
+  int animation = frame_graph.addTask(
+    "animation", 0, ANIMATION, [this] { updateAnimation(); });
+
+  frame_graph.addTask("render list",
+                      CAMERA | SHIP | ALIENS | LASERS | FORMATION | ANIMATION,
+                      RENDER_LIST,
+                      [this] { buildRenderList(); },
+                      { formation, animation });
+
+#ifndef NDEBUG
+  bool valid = frame_graph.validate();
+  assert(valid && "frame graph phases race on a shared resource");
+#endif
+
+  // the whole graph is recorded first, then each of its tasks
+  std::vector<std::string> phases{ "frame graph" };
+  for (std::size_t i = 0; i < frame_graph.size(); ++i)
+  {
+    phases.push_back(frame_graph.taskName(i));
+  }
+  telemetry.setPhases(phases);
+}
+
+/**
+ *   @brief   Registers the optional work with the governor
+ *   @details Only work that changes how the game looks, never how
+ *            it plays, is registered. Animations are shed first by
+ *            advancing them less often, then distant rows of aliens
+ *            are moved less often. Both catch up on the time they
+ *            skip, so nothing falls behind. Rows are only skipped in
+ *            the movement modes where catching up in one step lands
+ *            where the skipped steps would have, and the wave turns
+ *            where it would at full rate, so neither changes play.
+ *   @return  void
+ */
+void SpaceInvadersGame::setupGovernor()
+{
+  governor.addSubsystem("animation", 0, 2, [this](int level) {
+    animation_stride = 1u << level;
+  });
+
+  governor.addSubsystem("distant rows", 1, 2, [this](int level) {
+    lod_interval = LOD_INTERVAL << level;
+  });
+}
+
+/**
+ *   @brief   Loads the sprites used to draw the game
+ *   @details The renderer draws with sprites of its own, one for
+ *            each texture, so it never reads the sprites that the
+ *            simulation is moving.
+ *   @return  True if every texture loaded.
+ */
+bool SpaceInvadersGame::setupStamps()
+{
+  PROFILE_SCOPE("load textures");
+  StartupStage stage("textures");
+  const std::array<std::string, TEXTURE_COUNT> textures{
+    "data/Textures/spritesheet_spaceships.png",
+    "data/Textures/laserRed01.png",
+    "data/Textures/playerShip1_red.png"
+  };
+
+  for (std::size_t i = 0; i < textures.size(); ++i)
+  {
+    stamps[i] = renderer->createUniqueSprite();
+    if (!stamps[i]->loadTexture(textures[i]))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ *   @brief   Places the aliens, the ship and its lasers
+ *   @details Each object's sprite only holds its position and size,
+ *            which is copied from the stamp that draws it, so no
+ *            texture is loaded again for every object.
+ *   @return  True if every object was created.
+ */
+bool SpaceInvadersGame::setupEntities()
+{
+  StartupStage stage("entities");
+  float row = 100;
+
+  for (int i = 0; i < aliens_init; ++i)
+  {
+    if (!aliens[i].addSpriteComponent(renderer.get(),
+                                      *stamps[ALIEN_TEXTURE]))
+    {
+      return false;
+    }
+
+    ASGE::Sprite* alienSprite = aliens[i].spriteComponent()->getSprite();
+    alienSprite->height(70);
+    alienSprite->width(70);
+    alienSprite->xPos(float(i % alien_columns) * alienSprite->width());
+    alienSprite->yPos(row + float(i / alien_columns) * alienSprite->height());
+    aliens[i].visibility = true;
+  }
+
+  if (!ship.addSpriteComponent(renderer.get(), *stamps[SHIP_TEXTURE]))
+  {
+    return false;
+  }
+
+  ASGE::Sprite* shipSprite = ship.spriteComponent()->getSprite();
+  shipSprite->height(70);
+  shipSprite->width(70);
+  shipSprite->xPos((world_width / 2.f) - (shipSprite->width() / 2.f));
+  shipSprite->yPos(world_height - 220);
+
+  for (int i = 0; i < shots_max; ++i)
+  {
+    if (!ship_laser[i].addSpriteComponent(renderer.get(),
+                                          *stamps[LASER_TEXTURE]))
+    {
+      return false;
+    }
+
+    ASGE::Sprite* laserSprite = ship_laser[i].spriteComponent()->getSprite();
+    laserSprite->xPos(shipSprite->xPos());
+    laserSprite->yPos(shipSprite->yPos());
+    ship_laser[i].visibility = false;
+  }
+
+  return true;
+}
+
 /**
  *   @brief   Processes any key inputs
  *   @details This function is added as a callback to handle the game's
- *            keyboard input. For this game, calls to this function
- *            are thread safe, so you may alter the game's state as
- *            you see fit.
+ *            keyboard input. It may be called on the engine's input
+ *            thread, so the event is only copied into the input queue,
+ *            along with when it arrived. The simulation applies it at
+ *            the start of its next step.
  *   @param   data The event data relating to key input.
  *   @see     KeyEvent
  *   @return  void
@@ -182,84 +466,191 @@ void SpaceInvadersGame::keyHandler(const ASGE::SharedEventData data)
 {
   auto key = static_cast<const ASGE::KeyEvent*>(data.get());
 
-  if (key->key == ASGE::KEYS::KEY_ESCAPE)
+  InputEvent event;
+  event.key = key->key;
+  event.action = key->action;
+  event.mods = key->mods;
+  event.timestamp = std::chrono::steady_clock::now();
+  input_queue.push(event);
+}
+
+/**
+ *   @brief   Applies the keys queued since the last step
+ *   @details Runs on the simulation thread before anything moves.
+ *            A key pressed and released between two steps would
+ *            otherwise never be seen, so its release is held back
+ *            until the step has run.
+ *   @return  void
+ */
+void SpaceInvadersGame::applyInput()
+{
+  std::bitset<KEY_CODES> pressed;
+  InputEvent event;
+
+  while (input_queue.pop(event))
+  {
+    PROFILE_INSTANT("key", event.timestamp);
+    bool tracked = event.key >= 0 && event.key < KEY_CODES;
+    auto code = static_cast<std::size_t>(tracked ? event.key : 0);
+
+    if (tracked && event.action == ASGE::KEYS::KEY_RELEASED &&
+        pressed[code] && deferred_count < deferred_input.size())
+    {
+      deferred_input[deferred_count++] = event;
+      continue;
+    }
+
+    if (tracked && event.action == ASGE::KEYS::KEY_PRESSED)
+    {
+      // pressed again, so the held back release no longer applies
+      auto end = deferred_input.begin() + deferred_count;
+      end = std::remove_if(
+        deferred_input.begin(), end, [&](const InputEvent& deferred) {
+          return deferred.key == event.key;
+        });
+      deferred_count = static_cast<std::size_t>(end - deferred_input.begin());
+      pressed.set(code);
+    }
+
+    applyKey(event);
+  }
+}
+
+/**
+ *   @brief   Applies the releases held back by applyInput
+ *   @return  void
+ */
+void SpaceInvadersGame::applyDeferredInput()
+{
+  for (std::size_t i = 0; i < deferred_count; ++i)
+  {
+    applyKey(deferred_input[i]);
+  }
+
+  deferred_count = 0;
+}
+
+/**
+ *   @brief   Applies a key to the game's state
+ *   @details Changes which screen is shown and the controls used by
+ *            the simulation.
+ *   @param   key The key that was pressed or released.
+ *   @return  void
+ */
+void SpaceInvadersGame::applyKey(const InputEvent& key)
+{
+  auto now = LatencyTracker::clock::now();
+  latency.record(LatencyTracker::APPLIED, key.timestamp, now);
+  if (step_input_count < step_inputs.size())
+  {
+    step_inputs[step_input_count++] = key.timestamp;
+  }
+  else
+  {
+    ++step_inputs_left_out;
+  }
+
+  if (key.key == ASGE::KEYS::KEY_ESCAPE)
   {
     signalExit();
   }
 
-  if (in_menu && key->key == ASGE::KEYS::KEY_ENTER)
+  if (in_menu && key.key == ASGE::KEYS::KEY_ENTER)
   {
     in_menu = false;
     movement = true;
   }
 
-  if (key->key == ASGE::KEYS::KEY_A && key->action == ASGE::KEYS::KEY_PRESSED)
+  if (key.key == ASGE::KEYS::KEY_A && key.action == ASGE::KEYS::KEY_PRESSED)
   {
     ship_left = true;
   }
-  if (key->key == ASGE::KEYS::KEY_A && key->action == ASGE::KEYS::KEY_RELEASED)
+  if (key.key == ASGE::KEYS::KEY_A && key.action == ASGE::KEYS::KEY_RELEASED)
   {
     ship_left = false;
   }
-  if (key->key == ASGE::KEYS::KEY_D && key->action == ASGE::KEYS::KEY_PRESSED)
+  if (key.key == ASGE::KEYS::KEY_D && key.action == ASGE::KEYS::KEY_PRESSED)
   {
     ship_right = true;
   }
-  if (key->key == ASGE::KEYS::KEY_D && key->action == ASGE::KEYS::KEY_RELEASED)
+  if (key.key == ASGE::KEYS::KEY_D && key.action == ASGE::KEYS::KEY_RELEASED)
   {
     ship_right = false;
   }
 
-  if (key->key == ASGE::KEYS::KEY_SPACE &&
-      key->action == ASGE::KEYS::KEY_PRESSED)
+  if (key.key == ASGE::KEYS::KEY_W && key.action != ASGE::KEYS::KEY_REPEATED)
+  {
+    camera_up = key.action == ASGE::KEYS::KEY_PRESSED;
+  }
+  if (key.key == ASGE::KEYS::KEY_S && key.action != ASGE::KEYS::KEY_REPEATED)
+  {
+    camera_down = key.action == ASGE::KEYS::KEY_PRESSED;
+  }
+
+  if (key.key == ASGE::KEYS::KEY_SPACE &&
+      key.action == ASGE::KEYS::KEY_PRESSED)
   {
     fired = true;
   }
-  if (key->key == ASGE::KEYS::KEY_1 && key->action == ASGE::KEYS::KEY_PRESSED)
+  if (key.key == ASGE::KEYS::KEY_TAB && key.action == ASGE::KEYS::KEY_PRESSED)
+  {
+    show_frame_graph = !show_frame_graph;
+  }
+  if (key.key == ASGE::KEYS::KEY_P && key.action == ASGE::KEYS::KEY_PRESSED)
+  {
+    show_profiler = !show_profiler;
+  }
+  if (key.key == ASGE::KEYS::KEY_T && key.action == ASGE::KEYS::KEY_PRESSED)
+  {
+    Profiler::startTrace(
+      settings.trace_frames > 0 ? settings.trace_frames : TRACE_FRAMES,
+      settings.trace_file);
+  }
+  if (key.key == ASGE::KEYS::KEY_1 && key.action == ASGE::KEYS::KEY_PRESSED)
   {
     movement = false;
     alien_movement = 1;
     playing = true;
   }
-  if (key->key == ASGE::KEYS::KEY_2 && key->action == ASGE::KEYS::KEY_PRESSED)
+  if (key.key == ASGE::KEYS::KEY_2 && key.action == ASGE::KEYS::KEY_PRESSED)
   {
     movement = false;
     alien_movement = 2;
     playing = true;
   }
-  if (key->key == ASGE::KEYS::KEY_3 && key->action == ASGE::KEYS::KEY_PRESSED)
+  if (key.key == ASGE::KEYS::KEY_3 && key.action == ASGE::KEYS::KEY_PRESSED)
   {
     movement = false;
     alien_movement = 3;
     playing = true;
   }
-  if (key->key == ASGE::KEYS::KEY_4 && key->action == ASGE::KEYS::KEY_PRESSED)
+  if (key.key == ASGE::KEYS::KEY_4 && key.action == ASGE::KEYS::KEY_PRESSED)
   {
     movement = false;
     alien_movement = 4;
     playing = true;
 
-    if (key->key == ASGE::KEYS::KEY_SPACE &&
-        key->action == ASGE::KEYS::KEY_PRESSED)
+    if (key.key == ASGE::KEYS::KEY_SPACE &&
+        key.action == ASGE::KEYS::KEY_PRESSED)
     {
       fired = true;
     }
-    if (key->key == ASGE::KEYS::KEY_1 && key->action == ASGE::KEYS::KEY_PRESSED)
+    if (key.key == ASGE::KEYS::KEY_1 && key.action == ASGE::KEYS::KEY_PRESSED)
     {
       movement = false;
       playing = true;
     }
-    if (key->key == ASGE::KEYS::KEY_2 && key->action == ASGE::KEYS::KEY_PRESSED)
+    if (key.key == ASGE::KEYS::KEY_2 && key.action == ASGE::KEYS::KEY_PRESSED)
     {
       movement = false;
       playing = true;
     }
-    if (key->key == ASGE::KEYS::KEY_3 && key->action == ASGE::KEYS::KEY_PRESSED)
+    if (key.key == ASGE::KEYS::KEY_3 && key.action == ASGE::KEYS::KEY_PRESSED)
     {
       movement = false;
       playing = true;
     }
-    if (key->key == ASGE::KEYS::KEY_4 && key->action == ASGE::KEYS::KEY_PRESSED)
+    if (key.key == ASGE::KEYS::KEY_4 && key.action == ASGE::KEYS::KEY_PRESSED)
     {
       movement = false;
       playing = true;
@@ -284,15 +675,18 @@ void SpaceInvadersGame::clickHandler(const ASGE::SharedEventData data)
   double x_pos = click->xpos;
   double y_pos = click->ypos;
 
-  ASGE::DebugPrinter{} << "x_pos: " << x_pos << std::endl;
-  ASGE::DebugPrinter{} << "y_pos: " << y_pos << std::endl;
+  AsyncLogger::log("Click at x_pos: {}, y_pos: {}", x_pos, y_pos);
 }
 
 /**
  *   @brief   Updates the scene
- *   @details Prepares the renderer subsystem before drawing the
- *            current frame. Once the current frame is has finished
- *            the buffers are swapped accordingly and the image shown.
+ *   @details The simulation runs a frame ahead on its own thread.
+ *            The step started last frame is finished, then the next
+ *            step is started so it runs whilst this frame is
+ *            rendered. Waiting keys keep a static screen awake. The
+ *            governor is given the longer of the step and the render's
+ *            own work, as the two run side by side. Pacing, presenting
+ *            and waiting for the display are never counted as work.
  *   @return  void
  */
 void SpaceInvadersGame::update(const ASGE::GameTime& game_time)
@@ -300,66 +694,229 @@ void SpaceInvadersGame::update(const ASGE::GameTime& game_time)
   // auto dt_sec = game_time.delta.count() / 1000.0;;
   // make sure you use delta time in any movement calculations!
 
+  // the last frame drawn has been swapped on screen by now
+  if (render_end != Profiler::clock::time_point{})
+  {
+    PROFILE_SPAN("present", render_end, Profiler::clock::now());
+    StartupProfiler::firstFrame();
+  }
+
+  if (awaiting_present)
+  {
+    recordInputLatency(LatencyTracker::PRESENTED);
+    awaiting_present = false;
+  }
+
+  simulation.join();
+  if (step_kicked)
+  {
+    governor.endFrame(std::max(step_ms, render_ms));
+    step_kicked = false;
+  }
+
+  // fixed text screens don't need redrawing until something changes
+  bool is_static = isStaticScene() && input_queue.empty();
+  if (settings.idle_throttle &&
+      idle_throttle.isIdle(is_static, sceneFingerprint()))
+  {
+    idle_throttle.waitForEvents();
+    frame_pacer.reset();
+    telemetry.pause();
+    return;
+  }
+
+  frame_pacer.waitForNextFrame();
+  telemetry.beginFrame(SessionTelemetry::clock::now());
+
+  Profiler::beginFrame();
+  step_time = game_time;
+
+  // the input that woke the loop is applied now, but the time spent
+  // asleep isn't simulated
+  if (idle_throttle.resumedFromIdle())
+  {
+    step_time.delta = std::min(step_time.delta, IDLE_RESUME_DELTA);
+  }
+  simulation.kick();
+  step_kicked = true;
+}
+
+/**
+ *   @brief   Simulates a frame
+ *   @details Runs on the simulation thread. Input is applied first,
+ *            then the finished frame is published for the renderer,
+ *            along with the menus.
+ *   @return  void
+ */
+void SpaceInvadersGame::step()
+{
+  PROFILE_SCOPE("step");
+  Profiler::clock::time_point step_start = Profiler::clock::now();
+  applyInput();
+
   if (!in_menu)
   {
-    alienMovement(game_time);
-    shipMovement(game_time);
-    laserMovement(game_time);
+    frame_graph.run(jobs);
 
-    for (int i = 0; i < aliens_init; ++i)
+    telemetry.recordPhase(0, frame_graph.spanMs());
+    for (std::size_t i = 0; i < frame_graph.size(); ++i)
     {
-      if (aliens[i].spriteComponent()->getBoundingBox().isInside(
-            ship.spriteComponent()->getBoundingBox()) &&
-          aliens[i].visibility)
-      {
-        playing = false;
-        game_lose = true;
-      }
+      telemetry.recordPhase(i + 1, frame_graph.taskMs(i));
     }
+  }
 
-    if (aliens_remaining == 0)
-    {
-      game_won = true;
-      playing = false;
-    }
+  applyDeferredInput();
+  publishSnapshot();
+  publishMetrics();
+  step_ms = std::chrono::duration<double, std::milli>(
+              Profiler::clock::now() - step_start)
+              .count();
+}
 
-    for (int i = 0; i < aliens_init; ++i)
-    {
-      if (aliens[i].spriteComponent()->getBoundingBox().isInside(
-            ship.spriteComponent()->getBoundingBox()) &&
-          aliens[i].visibility)
-      {
-        playing = false;
-        game_lose = true;
-      }
-    }
+/**
+ *   @brief   Publishes the latest frame to the renderer
+ *   @details Copies the draw list and the values shown on screen.
+ *            The snapshot buffers keep their capacity, so this
+ *            doesn't allocate once the game is running.
+ *   @return  void
+ */
+void SpaceInvadersGame::publishSnapshot()
+{
+  PROFILE_SCOPE("snapshot");
+  FrameSnapshot& snapshot = snapshots.writeBuffer();
+  snapshot.items = render_list.items();
+  snapshot.score = score;
+  snapshot.in_menu = in_menu;
+  snapshot.movement = movement;
+  snapshot.playing = playing;
+  snapshot.game_lose = game_lose;
+  snapshot.game_won = game_won;
+  snapshot.critical_path_ms = frame_graph.criticalPathMs();
+  snapshot.span_ms = frame_graph.spanMs();
+  snapshot.show_frame_graph = show_frame_graph;
+  snapshot.show_profiler = show_profiler;
+  std::copy_n(step_inputs.begin(), step_input_count, snapshot.inputs.begin());
+  snapshot.input_count = step_input_count;
+  snapshot.inputs_left_out = step_inputs_left_out;
+  step_input_count = 0;
+  step_inputs_left_out = 0;
+  snapshots.publish();
+}
 
-    if (aliens_remaining == 0)
+/**
+ *   @brief   Publishes the frame's metrics to external monitors
+ *   @details Only called on the simulation thread, after the frame
+ *            graph has finished, so nothing here can race.
+ *   @return  void
+ */
+void SpaceInvadersGame::publishMetrics()
+{
+  if (!metrics.isOpen())
+  {
+    return;
+  }
+
+  auto now = Profiler::clock::now();
+  MetricsFrame frame{};
+  frame.frame = ++metrics_frame;
+  if (metrics_time != Profiler::clock::time_point{})
+  {
+    std::chrono::duration<float, std::milli> elapsed = now - metrics_time;
+    frame.frame_ms = elapsed.count();
+  }
+  metrics_time = now;
+
+  if (!in_menu)
+  {
+    frame.graph_ms = static_cast<float>(frame_graph.spanMs());
+    frame.phase_count = static_cast<std::uint32_t>(std::min<std::size_t>(
+      frame_graph.size(), MetricsFrame::MAX_PHASES));
+    for (std::uint32_t i = 0; i < frame.phase_count; ++i)
     {
-      game_won = true;
-      playing = false;
+      MetricsFrame::Phase& phase = frame.phases[i];
+      std::strncpy(phase.name,
+                   frame_graph.taskName(i).c_str(),
+                   MetricsFrame::NAME_LENGTH - 1);
+      phase.ms = static_cast<float>(frame_graph.taskMs(i));
     }
   }
+
+  frame.aliens_alive = static_cast<std::uint32_t>(aliens_remaining);
+  frame.aliens_total = static_cast<std::uint32_t>(aliens.size());
+  for (const GameObject& laser : ship_laser)
+  {
+    frame.lasers_live += laser.visibility ? 1 : 0;
+  }
+  frame.collision_pairs = static_cast<std::uint32_t>(collision_pairs);
+
+  std::uint64_t allocations = AllocationCounter::count();
+  frame.allocations = allocations;
+  frame.frame_allocations =
+    static_cast<std::uint32_t>(allocations - metrics_allocations);
+  metrics_allocations = allocations;
+
+  frame.score = score;
+  frame.in_menu = in_menu;
+  frame.movement = movement;
+  frame.playing = playing;
+  frame.game_won = game_won;
+  frame.game_lose = game_lose;
+  metrics.publish(frame);
+}
+
+/**
+ *   @brief   Is a fixed text screen being shown?
+ *   @details Menus and end screens contain nothing that animates.
+ *   @return  True if the scene only changes in response to input.
+ */
+bool SpaceInvadersGame::isStaticScene() const
+{
+  return !playing && (in_menu || movement || game_lose || game_won);
+}
+
+/**
+ *   @brief   Hashes everything visible on a static screen
+ *   @details Combines the flags that choose which screen is drawn
+ *            along with the score, so any change to them forces
+ *            the scene to be presented again.
+ *   @return  The scene fingerprint.
+ */
+std::size_t SpaceInvadersGame::sceneFingerprint() const
+{
+  std::size_t flags = static_cast<std::size_t>(in_menu) |
+                      static_cast<std::size_t>(movement) << 1 |
+                      static_cast<std::size_t>(playing) << 2 |
+                      static_cast<std::size_t>(game_lose) << 3 |
+                      static_cast<std::size_t>(game_won) << 4;
+
+  return std::hash<std::size_t>{}(flags) ^
+         (std::hash<int>{}(score) + 0x9e3779b9 + (flags << 6) + (flags >> 2));
 }
 
 /**
  *   @brief   Renders the scene
- *   @details Renders all the game objects to the current frame.
+ *   @details Renders the latest snapshot published by the simulation.
  *            Once the current frame is has finished the buffers are
  *            swapped accordingly and the image shown.
  *   @return  void
  */
 void SpaceInvadersGame::render(const ASGE::GameTime&)
 {
+  PROFILE_SCOPE("render");
+  Profiler::clock::time_point render_start = Profiler::clock::now();
+  bool fresh = snapshots.fetch();
+  const FrameSnapshot& frame = snapshots.readBuffer();
+  PERF_COUNT_SCOPE("render", frame.items.size());
+
   renderer->setFont(0);
 
-  if (in_menu)
+  if (frame.in_menu)
   {
     std::string welcome = "Press enter to start the game";
 
     renderer->renderText(welcome, 150, 360, 1.0, ASGE::COLOURS::WHITE);
   }
-  else if (movement)
+  else if (frame.movement)
   {
     std::string move = "Please select alien movement";
     std::string normal = "1 : Normal";
@@ -373,34 +930,41 @@ void SpaceInvadersGame::render(const ASGE::GameTime&)
     renderer->renderText(quadratic, 150, 400, 1.0, ASGE::COLOURS::WHITE);
     renderer->renderText(sine, 150, 425, 1.0, ASGE::COLOURS::WHITE);
   }
-  else if (playing)
+  else if (frame.playing)
   {
-    std::string score_str = "Score:" + std::to_string(score);
+    std::string score_str = "Score:" + std::to_string(frame.score);
     renderer->renderText(score_str, 500, 75, 1.0, ASGE::COLOURS::WHITE);
-    renderer->renderSprite(*ship.spriteComponent()->getSprite());
 
-    for (int i = 0; i < aliens_init; ++i)
+    if (frame.show_frame_graph)
     {
-      if (aliens[i].visibility)
-      {
-        renderer->renderSprite(*aliens[i].spriteComponent()->getSprite());
-      }
+      char timings[64];
+      std::snprintf(timings,
+                    sizeof(timings),
+                    "Critical path: %.2fms of %.2fms",
+                    frame.critical_path_ms,
+                    frame.span_ms);
+      renderer->renderText(timings, 20, 900, 0.5, ASGE::COLOURS::WHITE);
     }
-    for (int i = 0; i < shots_max; ++i)
+
     {
-      if (ship_laser[i].visibility)
+      PROFILE_SCOPE("submit");
+      for (const RenderItem& item : frame.items)
       {
-        renderer->renderSprite(*ship_laser[i].spriteComponent()->getSprite());
-        ship_laser[i].visibility = true;
+        submitRenderItem(item);
       }
     }
+
+    if (frame.show_profiler)
+    {
+      renderProfiler();
+    }
   }
-  else if (game_lose)
+  else if (frame.game_lose)
   {
     renderer->renderText(
       "You Lose", game_width / 3, game_height / 2, 2.0, ASGE::COLOURS::WHITE);
   }
-  else if (game_won)
+  else if (frame.game_won)
   {
     renderer->renderText("Congratulations",
                          game_width / 3,
@@ -408,176 +972,504 @@ void SpaceInvadersGame::render(const ASGE::GameTime&)
                          2.0,
                          ASGE::COLOURS::WHITE);
   }
+
+  // input in a new frame reaches the screen along with it
+  if (fresh && frame.input_count > 0)
+  {
+    recordInputLatency(LatencyTracker::SUBMITTED);
+    awaiting_present = true;
+  }
+
+  render_end = Profiler::clock::now();
+  render_ms =
+    std::chrono::duration<double, std::milli>(render_end - render_start)
+      .count();
 }
 
-void SpaceInvadersGame::alienMovement(const ASGE::GameTime& game_time)
+/**
+ *   @brief   Draws the profiler overlay
+ *   @details Shows the rolling min, average and max time of each
+ *            phase. The text is rebuilt a couple of times a second
+ *            so it can be read, and so summarising stays cheap.
+ *   @return  void
+ */
+void SpaceInvadersGame::renderProfiler()
 {
-  for (int i = 0; i < aliens_init; ++i)
+  if (profiler_frames++ % PROFILER_REFRESH == 0)
   {
-    float x_pos = aliens[i].spriteComponent()->getSprite()->xPos();
-    float y_pos = aliens[i].spriteComponent()->getSprite()->yPos();
-    float multiply = 2.0f;
-    auto delta_time = game_time.delta.count();
-
-    if (alien_left)
+    profiler_lines.clear();
+    for (const PhaseStats& phase : Profiler::summary())
     {
-      velocity.setx(-1);
+      char line[96];
+      std::snprintf(line,
+                    sizeof(line),
+                    "%s: %.2f / %.2f / %.2f",
+                    phase.name.c_str(),
+                    phase.min_ms,
+                    phase.avg_ms,
+                    phase.max_ms);
+      profiler_lines.emplace_back(line);
+    }
+  }
 
-      if (aliens[i].visibility && x_pos <= 0)
-      {
-        alien_left = false;
+  float y = 100;
+  renderer->renderText(
+    "Phase min / avg / max ms", 20, y, 0.5, ASGE::COLOURS::WHITE);
+  if (profiler_lines.empty())
+  {
+    renderer->renderText(
+      "No phases timed", 20, y + 20, 0.5, ASGE::COLOURS::WHITE);
+  }
 
-        for (int j = 0; j < aliens_init; ++j)
-        {
-          y_pos = ((aliens[j].spriteComponent()->getSprite()->yPos()) +
-                   (aliens[j].spriteComponent()->getSprite()->height() / 2));
-          aliens[j].spriteComponent()->getSprite()->yPos(y_pos);
-        }
-      }
-      else
-      {
-        x_pos += 60 * velocity.getx() * static_cast<float>(delta_time / 1000.f);
-        aliens[i].spriteComponent()->getSprite()->xPos(x_pos);
-      }
-      if (alien_movement == 2)
-      {
-        y_pos += static_cast<float>(
-          9.8f * aliens[i].spriteComponent()->getSprite()->yPos() * delta_time /
-          100000.f);
-        aliens[i].spriteComponent()->getSprite()->yPos(y_pos);
-      }
-      else if (alien_movement == 3)
-      {
-        float middle_x =
-          float(game_width) / 2 -
-          (aliens[i].spriteComponent()->getSprite()->width() / 2);
-        float offset = x_pos - middle_x;
-
-        x_pos += aliens[i].spriteComponent()->getSprite()->xPos() * multiply;
-        y_pos = (-1 * offset / 20 * offset / 20 +
-                 aliens[i].spriteComponent()->getSprite()->height() * 4);
-        aliens[i].spriteComponent()->getSprite()->yPos(y_pos);
-      }
-      else if (alien_movement == 4)
-      {
-        alien_sine[i].normalise();
-        y_pos = aliens[i].spriteComponent()->getSprite()->yPos();
+  for (const std::string& line : profiler_lines)
+  {
+    y += 20;
+    renderer->renderText(line, 20, y, 0.5, ASGE::COLOURS::WHITE);
+  }
+}
 
-        aliens[i].spriteComponent()->getSprite()->xPos(
-          alien_sine[i].x -
-          (100.f * static_cast<float>(
-                     sin(static_cast<long double>(delta_time)) / 150)) +
-          x_pos);
+/**
+ *   @brief   Records the latency of the input in the frame on screen
+ *   @details Measured for every input applied in the frame's step,
+ *            up to MAX_STEP_INPUTS. The rest are counted, so the
+ *            report says how many it left out.
+ *   @return  void
+ */
+void SpaceInvadersGame::recordInputLatency(LatencyTracker::Stage stage)
+{
+  const FrameSnapshot& frame = snapshots.readBuffer();
+  auto now = LatencyTracker::clock::now();
 
-        y_pos += static_cast<float>(30 * (delta_time / 1000.f));
-        aliens[i].spriteComponent()->getSprite()->yPos(y_pos);
-      }
-    }
+  for (std::size_t i = 0; i < frame.input_count; ++i)
+  {
+    latency.record(stage, frame.inputs[i], now);
+  }
+  latency.leaveOut(stage, frame.inputs_left_out);
+}
 
-    if (!alien_left)
+/**
+ *   @brief   Builds the draw list for the playing screen
+ *   @details The rows of aliens are shared out between the worker
+ *            threads. Each job culls its rows, then its aliens,
+ *            against the camera and transforms the survivors into
+ *            screen space. The first job also queues the ship and
+ *            lasers. Small waves are built by a single job.
+ *   @return  void
+ */
+void SpaceInvadersGame::buildRenderList()
+{
+  std::size_t rows = row_bounds.size();
+  std::size_t job_count = std::min(
+    jobs.concurrency(), std::max<std::size_t>(1, aliens.size() / 1024));
+
+  auto build = [&](std::size_t job, std::vector<RenderItem>& out) {
+    auto queue = [&](GameObject& object,
+                     std::uint8_t layer,
+                     SpriteTexture texture) {
+      ASGE::Sprite* sprite = object.spriteComponent()->getSprite();
+      RenderItem item;
+      item.texture = texture;
+      item.x = camera.toScreenX(sprite->xPos());
+      item.y = camera.toScreenY(sprite->yPos());
+      item.width = sprite->width();
+      item.height = sprite->height();
+      item.sort_key = RenderList::sortKey(layer, item.y);
+      out.push_back(item);
+      return &out.back();
+    };
+
+    if (job == 0)
     {
-      velocity.setx(1);
-
-      if (aliens[i].visibility && x_pos >= 640)
+      queue(ship, SHIP_LAYER, SHIP_TEXTURE);
+      for (auto& laser : ship_laser)
       {
-        alien_left = true;
-
-        for (int j = 0; j < aliens_init; ++j)
+        if (laser.visibility &&
+            camera.isVisible(laser.spriteComponent()->getBoundingBox()))
         {
-          y_pos = ((aliens[j].spriteComponent()->getSprite()->yPos()) +
-                   (aliens[j].spriteComponent()->getSprite()->height() / 2));
-          aliens[j].spriteComponent()->getSprite()->yPos(y_pos);
+          queue(laser, LASER_LAYER, LASER_TEXTURE);
         }
       }
-      else
+    }
+
+    // whole rows are culled before any of their aliens are looked at
+    for (std::size_t row = job * rows / job_count;
+         row < (job + 1) * rows / job_count;
+         ++row)
+    {
+      const rect& bounds = row_bounds[row];
+      if (bounds.length <= 0 || !camera.isVisible(bounds))
       {
-        x_pos += 60 * velocity.getx() *
-                 static_cast<float>(game_time.delta.count() / 1000.f);
-        aliens[i].spriteComponent()->getSprite()->xPos(x_pos);
+        continue;
       }
 
-      if (alien_movement == 2)
+      int first = static_cast<int>(row) * alien_columns;
+      for (int i = first; i < first + alien_columns; ++i)
       {
-        y_pos += static_cast<float>(
-          9.8f * aliens[i].spriteComponent()->getSprite()->yPos() * delta_time /
-          100000.f);
-        aliens[i].spriteComponent()->getSprite()->yPos(y_pos);
+        if (aliens[i].visibility &&
+            camera.isVisible(aliens[i].spriteComponent()->getBoundingBox()))
+        {
+          RenderItem* item = queue(aliens[i], ALIEN_LAYER, ALIEN_TEXTURE);
+          item->frame = animator.frameOf(alien_animation, i % alien_columns);
+        }
       }
-      else if (alien_movement == 3)
+    }
+  };
+  render_list.build(job_count, build);
+}
+
+/**
+ *   @brief   Draws an item from the draw list
+ *   @details The simulation owns the game's sprites, so items are
+ *            drawn by stamping one of the renderer's own sprites.
+ *            The renderer copies the sprite's state into its batch,
+ *            so one sprite per texture is all that's needed.
+ *   @return  void
+ */
+void SpaceInvadersGame::submitRenderItem(const RenderItem& item)
+{
+  ASGE::Sprite& sprite = *stamps[item.texture];
+  if (item.frame >= 0)
+  {
+    animator.applyFrame(sprite, item.frame);
+  }
+
+  sprite.xPos(item.x);
+  sprite.yPos(item.y);
+  sprite.width(item.width);
+  sprite.height(item.height);
+  renderer->renderSprite(sprite);
+}
+
+/**
+ *   @brief   Recalculates the bounds of each row of aliens
+ *   @details Rows are the grid used to cull the wave. A row's
+ *            bounds cover every alien still alive in it, and an
+ *            empty row is given no length, which culling skips. Only
+ *            rows moved or hit this frame are measured again. Each
+ *            row's update rate for the next frame is then picked
+ *            from how close it is to the action.
+ *   @return  void
+ */
+void SpaceInvadersGame::updateFormationBounds()
+{
+  auto bound_rows = [&](std::size_t begin, std::size_t end) {
+    for (std::size_t row = begin; row < end; ++row)
+    {
+      if (!row_dirty[row])
       {
-        float middle_x =
-          float(game_width) / 2 -
-          (aliens[i].spriteComponent()->getSprite()->width() / 2);
-        float offset = x_pos - middle_x;
-
-        x_pos += aliens[i].spriteComponent()->getSprite()->xPos() * multiply;
-        y_pos = (-1 * offset / 20 * offset / 20 +
-                 aliens[i].spriteComponent()->getSprite()->height() * 4);
-        aliens[i].spriteComponent()->getSprite()->yPos(y_pos);
+        continue;
       }
-      else if (alien_movement == 4)
-      {
-        alien_sine[i].normalise();
-        y_pos = aliens[i].spriteComponent()->getSprite()->yPos();
 
-        aliens[i].spriteComponent()->getSprite()->xPos(
-          alien_sine[i].x +
-          (100.f * static_cast<float>(
-                     sin(static_cast<long double>(delta_time)) / 150)) +
-          x_pos);
+      float min_x = world_width;
+      float min_y = world_height;
+      float max_x = -world_width;
+      float max_y = -world_height;
 
-        y_pos += static_cast<float>(30 * (delta_time / 1000.f));
-        aliens[i].spriteComponent()->getSprite()->yPos(y_pos);
+      int first = static_cast<int>(row) * alien_columns;
+      for (int i = first; i < first + alien_columns; ++i)
+      {
+        if (aliens[i].visibility)
+        {
+          rect bounds = aliens[i].spriteComponent()->getBoundingBox();
+          min_x = std::min(min_x, bounds.x);
+          min_y = std::min(min_y, bounds.y);
+          max_x = std::max(max_x, bounds.x + bounds.length);
+          max_y = std::max(max_y, bounds.y + bounds.height);
+        }
       }
+
+      rect& bounds = row_bounds[row];
+      bounds.x = min_x;
+      bounds.y = min_y;
+      bounds.length = std::max(0.f, max_x - min_x);
+      bounds.height = std::max(0.f, max_y - min_y);
+    }
+  };
+  jobs.parallelFor(0, row_bounds.size(), 64, bound_rows);
+
+  auto rate_rows = [&](std::size_t begin, std::size_t end) {
+    for (std::size_t row = begin; row < end; ++row)
+    {
+      row_full_rate[row] = isNearAction(row_bounds[row]) ? 1 : 0;
     }
+  };
+  jobs.parallelFor(0, row_bounds.size(), 256, rate_rows);
+}
+
+/**
+ *   @brief   Advances the animation clocks
+ *   @details Under load the governor has the clocks advanced every
+ *            few frames instead, by all the time since they last ran.
+ *   @return  void
+ */
+void SpaceInvadersGame::updateAnimation()
+{
+  animation_time += step_time.delta.count();
+  if (++animation_frames % animation_stride == 0)
+  {
+    animator.update(animation_time);
+    animation_time = 0;
   }
 }
 
-void SpaceInvadersGame::shipMovement(const ASGE::GameTime& game_time)
+/**
+ *   @brief   Checks whether a row of aliens is near the action
+ *   @details A row is near if it is within reach of the camera's
+ *            view, the ship or a live laser. The reach covers how
+ *            far things can move before a distant row next updates,
+ *            so anything that could be seen or hit stays exact.
+ *   @return  True if the row must move every frame.
+ */
+bool SpaceInvadersGame::isNearAction(const rect& bounds)
 {
-  float x_pos = ship.spriteComponent()->getSprite()->xPos();
+  if (bounds.length <= 0)
+  {
+    return false;
+  }
+
+  rect reach = bounds;
+  reach.x -= LOD_NEAR;
+  reach.y -= LOD_NEAR;
+  reach.length += 2 * LOD_NEAR;
+  reach.height += 2 * LOD_NEAR;
 
-  if (ship_left)
+  if (camera.isVisible(reach) ||
+      reach.isInside(ship.spriteComponent()->getBoundingBox()))
   {
-    velocity.setx(-1);
+    return true;
+  }
 
-    if (x_pos <= 0)
+  for (auto& laser : ship_laser)
+  {
+    if (laser.visibility &&
+        reach.isInside(laser.spriteComponent()->getBoundingBox()))
     {
-      ship_left = false;
+      return true;
     }
-    else
+  }
+
+  return false;
+}
+
+/**
+ *   @brief   Rebuilds the alien broadphase grid
+ *   @details Dead aliens are left out, so collision queries only
+ *            return aliens that are still alive and nearby.
+ *   @return  void
+ */
+void SpaceInvadersGame::buildBroadphase()
+{
+  rect world;
+  world.length = world_width;
+  world.height = world_height;
+
+  auto bounds_of = [&](std::size_t i, rect& out) {
+    if (!aliens[i].visibility)
     {
-      x_pos += 600 * velocity.getx() *
-               static_cast<float>(game_time.delta.count() / 1000.f);
-      ship.spriteComponent()->getSprite()->xPos(x_pos);
+      return false;
     }
+
+    out = aliens[i].spriteComponent()->getBoundingBox();
+    return true;
+  };
+  alien_grid.build(jobs, world, aliens.size(), bounds_of);
+}
+
+/**
+ *   @brief   Scrolls the camera
+ *   @details W and S pan the camera up and down the playfield.
+ *   @return  void
+ */
+void SpaceInvadersGame::cameraMovement(const ASGE::GameTime& game_time)
+{
+  float distance = 900 * static_cast<float>(game_time.delta.count() / 1000.f);
+
+  if (camera_up)
+  {
+    camera.scroll(0, -distance);
   }
+  if (camera_down)
+  {
+    camera.scroll(0, distance);
+  }
+}
 
-  if (ship_right)
+/**
+ *   @brief   Moves the alien wave
+ *   @details The wave reaches the edge of the playfield when any
+ *            row's bounds would at full rate, counting the time the
+ *            row has yet to move. Rows near the action move every
+ *            frame, while distant ones take turns to move every few
+ *            frames with all the time they missed, so the cost of a
+ *            huge wave follows the rows near the player. Before the
+ *            wave drops and turns, every row catches up on the way it
+ *            was going. Only the modes whose moves add up exactly
+ *            skip rows, so the wave plays the same either way.
+ *   @return  void
+ */
+void SpaceInvadersGame::alienMovement(const ASGE::GameTime& game_time)
+{
+  auto delta_time = game_time.delta.count();
+  std::size_t rows = row_bounds.size();
+  std::size_t columns = static_cast<std::size_t>(alien_columns);
+  std::size_t row_grain = std::max<std::size_t>(1, ALIEN_GRAIN / columns);
+
+  GameRules::AlienStep step;
+  step.mode = alien_movement;
+  step.direction = alien_left ? -1 : 1;
+  step.world_width = world_width;
+
+  // rows still owed time are tested where they would be at full rate
+  bool edge_reached = false;
+  for (std::size_t row = 0; row < rows; ++row)
+  {
+    const rect& bounds = row_bounds[row];
+    if (GameRules::rowAtEdge(step, bounds.x, bounds.length, row_pending[row]))
+    {
+      edge_reached = true;
+    }
+  }
+
+  if (edge_reached)
   {
-    velocity.setx(1);
+    auto catch_up = [&](std::size_t begin, std::size_t end) {
+      std::size_t behind = 0;
+      for (std::size_t row = begin; row < end; ++row)
+      {
+        behind += row_pending[row] > 0 ? 1 : 0;
+      }
+
+      PERF_COUNT_SCOPE("aliens", behind * columns);
+      for (std::size_t row = begin; row < end; ++row)
+      {
+        if (row_pending[row] > 0)
+        {
+          GameRules::AlienStep row_step = step;
+          row_step.delta_time = row_pending[row];
+          row_pending[row] = 0;
+          moveRow(row, row_step);
+        }
+      }
+    };
+    jobs.parallelFor(0, rows, row_grain, catch_up);
+
+    alien_left = !alien_left;
+
+    auto drop = [&](std::size_t begin, std::size_t end) {
+      PERF_COUNT_SCOPE("aliens", end - begin);
+      for (std::size_t i = begin; i < end; ++i)
+      {
+        ASGE::Sprite* sprite = aliens[i].spriteComponent()->getSprite();
+        sprite->yPos(sprite->yPos() + (sprite->height() / 2));
+      }
+    };
+    jobs.parallelFor(0, aliens.size(), ALIEN_GRAIN, drop);
+  }
 
-    if (x_pos >= 640 - ship.spriteComponent()->getSprite()->width())
+  velocity.setx(alien_left ? -1 : 1);
+
+  step.direction = velocity.getx();
+  step.delta_time = delta_time;
+  step.advance = !edge_reached;
+
+  // gravity compounds, so one long step falls further than many short
+  // ones, and the sine mode doesn't scale with time at all
+  bool reduced_rate =
+    alien_movement != 2 && alien_movement != 4 && !edge_reached;
+  ++lod_frame;
+
+  // only the rows that move are counted, not those skipped this frame
+  auto move = [&](std::size_t begin, std::size_t end) {
+    std::size_t due_rows = 0;
+    for (std::size_t row = begin; row < end; ++row)
     {
-      ship_right = false;
+      bool due = !reduced_rate || row_full_rate[row] ||
+                 (row + lod_frame) % lod_interval == 0;
+      row_dirty[row] = due ? 1 : 0;
+
+      if (!due)
+      {
+        row_pending[row] += delta_time;
+        continue;
+      }
+      ++due_rows;
     }
-    else
+
+    PERF_COUNT_SCOPE("aliens", due_rows * columns);
+    for (std::size_t row = begin; row < end; ++row)
     {
-      x_pos += 600 * velocity.getx() *
-               static_cast<float>(game_time.delta.count() / 1000.f);
-      ship.spriteComponent()->getSprite()->xPos(x_pos);
+      if (row_dirty[row] == 0)
+      {
+        continue;
+      }
+
+      GameRules::AlienStep row_step = step;
+      row_step.delta_time += row_pending[row];
+      row_pending[row] = 0;
+      moveRow(row, row_step);
     }
+  };
+  jobs.parallelFor(0, rows, row_grain, move);
+}
+
+/**
+ *   @brief   Moves a row of aliens.
+ *   @return  void
+ */
+void SpaceInvadersGame::moveRow(std::size_t row,
+                                const GameRules::AlienStep& step)
+{
+  std::size_t columns = static_cast<std::size_t>(alien_columns);
+  for (std::size_t i = row * columns; i < (row + 1) * columns; ++i)
+  {
+    moveAlien(i, step);
   }
 }
 
-void SpaceInvadersGame::laserMovement(const ASGE::GameTime& game_time)
+/**
+ *   @brief   Moves a single alien
+ *   @details Only touches the alien's own state, so it is safe to
+ *            call for different aliens from different threads.
+ *   @return  void
+ */
+void SpaceInvadersGame::moveAlien(std::size_t i,
+                                  const GameRules::AlienStep& step)
 {
-  auto delta_time = game_time.delta.count();
+  ASGE::Sprite* sprite = aliens[i].spriteComponent()->getSprite();
+  float x_pos = sprite->xPos();
+  float y_pos = sprite->yPos();
+
+  alien_sine[i].normalise();
+  GameRules::moveAlien(step,
+                       x_pos,
+                       y_pos,
+                       sprite->width(),
+                       sprite->height(),
+                       alien_sine[i].x);
+
+  sprite->xPos(x_pos);
+  sprite->yPos(y_pos);
+}
 
-  float y_pos = ship_laser[0].spriteComponent()->getSprite()->yPos();
-  float y_pos1 = ship_laser[1].spriteComponent()->getSprite()->yPos();
-  float y_pos2 = ship_laser[2].spriteComponent()->getSprite()->yPos();
+void SpaceInvadersGame::shipMovement(const ASGE::GameTime& game_time)
+{
+  PERF_COUNT_SCOPE("ship", 1);
+  ASGE::Sprite* sprite = ship.spriteComponent()->getSprite();
+  float x_pos = sprite->xPos();
+
+  GameRules::moveShip(x_pos,
+                      sprite->width(),
+                      world_width,
+                      ship_left,
+                      ship_right,
+                      game_time.delta.count());
+  sprite->xPos(x_pos);
+}
 
+void SpaceInvadersGame::laserMovement(const ASGE::GameTime& game_time)
+{
+  PERF_COUNT_SCOPE("lasers", static_cast<std::size_t>(shots_max));
+  auto delta_time = game_time.delta.count();
   double dt_sec = delta_time / 1000.f;
 
   if (fired && (shots_remaining == 3))
@@ -586,9 +1478,9 @@ void SpaceInvadersGame::laserMovement(const ASGE::GameTime& game_time)
     shots_remaining--;
     fired = false;
     ship_laser[0].spriteComponent()->getSprite()->xPos(
-      ship.spriteComponent()->getSprite()->xPos() + 36);
+      ship.spriteComponent()->getSprite()->xPos() + GameRules::MUZZLE_X);
     ship_laser[0].spriteComponent()->getSprite()->yPos(
-      ship.spriteComponent()->getSprite()->yPos() - 46);
+      ship.spriteComponent()->getSprite()->yPos() + GameRules::MUZZLE_Y);
   }
 
   if (fired && (shots_remaining == 2))
@@ -597,9 +1489,9 @@ void SpaceInvadersGame::laserMovement(const ASGE::GameTime& game_time)
     shots_remaining--;
     fired = false;
     ship_laser[1].spriteComponent()->getSprite()->xPos(
-      ship.spriteComponent()->getSprite()->xPos() + 36);
+      ship.spriteComponent()->getSprite()->xPos() + GameRules::MUZZLE_X);
     ship_laser[1].spriteComponent()->getSprite()->yPos(
-      ship.spriteComponent()->getSprite()->yPos() - 46);
+      ship.spriteComponent()->getSprite()->yPos() + GameRules::MUZZLE_Y);
   }
 
   if (fired && (shots_remaining == 1))
@@ -608,9 +1500,9 @@ void SpaceInvadersGame::laserMovement(const ASGE::GameTime& game_time)
     shots_remaining--;
     fired = false;
     ship_laser[2].spriteComponent()->getSprite()->xPos(
-      ship.spriteComponent()->getSprite()->xPos() + 36);
+      ship.spriteComponent()->getSprite()->xPos() + GameRules::MUZZLE_X);
     ship_laser[2].spriteComponent()->getSprite()->yPos(
-      ship.spriteComponent()->getSprite()->yPos() - 46);
+      ship.spriteComponent()->getSprite()->yPos() + GameRules::MUZZLE_Y);
   }
 
   // reloads shots when all laser sprites shot are gone
@@ -620,21 +1512,19 @@ void SpaceInvadersGame::laserMovement(const ASGE::GameTime& game_time)
     shots_remaining = 3;
   }
 
-  if (ship_laser[0].visibility) // laser movement
-  {
-    y_pos += float(200 * ship_laser[0].getVector()->y * dt_sec);
-    ship_laser[0].spriteComponent()->getSprite()->yPos(y_pos);
-  }
-  if (ship_laser[1].visibility) // laser movement
-  {
-    y_pos1 += float(200 * ship_laser[1].getVector()->y * dt_sec);
-    ship_laser[1].spriteComponent()->getSprite()->yPos(y_pos1);
-  }
-  if (ship_laser[2].visibility) // laser movement
-  {
-    y_pos2 += float(200 * ship_laser[2].getVector()->y * dt_sec);
-    ship_laser[2].spriteComponent()->getSprite()->yPos(y_pos2);
-  }
+  auto integrate = [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      if (ship_laser[i].visibility) // laser movement
+      {
+        ASGE::Sprite* sprite = ship_laser[i].spriteComponent()->getSprite();
+        sprite->yPos(sprite->yPos() +
+                     float(GameRules::LASER_SPEED *
+                           ship_laser[i].getVector()->y * dt_sec));
+      }
+    }
+  };
+  jobs.parallelFor(0, std::size_t(shots_max), PROJECTILE_GRAIN, integrate);
 
   // stops rendering laser sprites that have gone off screen and repositions
   for (int i = 0; i <= 2; i++)
@@ -644,37 +1534,104 @@ void SpaceInvadersGame::laserMovement(const ASGE::GameTime& game_time)
       fired = false;
       ship_laser[i].visibility = false;
       ship_laser[i].spriteComponent()->getSprite()->xPos(
-        ship.spriteComponent()->getSprite()->xPos() + 36);
+        ship.spriteComponent()->getSprite()->xPos() + GameRules::MUZZLE_X);
       ship_laser[i].spriteComponent()->getSprite()->yPos(
-        ship.spriteComponent()->getSprite()->yPos() - 46);
+        ship.spriteComponent()->getSprite()->yPos() + GameRules::MUZZLE_Y);
     }
   }
+}
 
-  for (int i = 0; i < shots_max; ++i) // collision detection
+/**
+ *   @brief   Finds this frame's collisions
+ *   @details Records the alien each laser hits, if any, and every
+ *            alien touching the ship. Nothing is changed here, so
+ *            this can't race with anything else that reads the wave.
+ *   @return  void
+ */
+void SpaceInvadersGame::findCollisions()
+{
+  PERF_COUNT_SCOPE("collision",
+                   aliens.size() + static_cast<std::size_t>(shots_max) + 1);
+  collision_pairs = 0;
+  for (int i = 0; i < shots_max; ++i)
   {
-    for (int j = 0; j < aliens_init; ++j)
-    {
-      if (ship_laser[i].spriteComponent()->getBoundingBox().isInside(
-            aliens[j].spriteComponent()->getBoundingBox()) &&
-          aliens[j].visibility)
+    rect laser_bounds = ship_laser[i].spriteComponent()->getBoundingBox();
+
+    // the lowest indexed alien is hit, whatever order the grid returns
+    std::size_t hit = aliens.size();
+    alien_grid.query(laser_bounds, [&](std::size_t j) {
+      ++collision_pairs;
+      if (j < hit && aliens[j].visibility &&
+          laser_bounds.isInside(aliens[j].spriteComponent()->getBoundingBox()))
       {
-        ship_laser[i].visibility = false;
-        ship_laser[i].spriteComponent()->getSprite()->xPos(
-          ship.spriteComponent()->getSprite()->xPos() + 36);
-        ship_laser[i].spriteComponent()->getSprite()->yPos(
-          ship.spriteComponent()->getSprite()->yPos() - 46);
-        aliens[j].visibility = false;
-        score += 10;
-        aliens_remaining--;
-      }
-      else if (ship_laser->spriteComponent()->getSprite()->yPos() < 100)
-      {
-        ship_laser[i].visibility = false;
-        ship_laser[i].spriteComponent()->getSprite()->xPos(
-          ship.spriteComponent()->getSprite()->xPos() + 36);
-        ship_laser[i].spriteComponent()->getSprite()->yPos(
-          ship.spriteComponent()->getSprite()->yPos() - 46);
+        hit = j;
       }
+    });
+    laser_hits[static_cast<std::size_t>(i)] = hit;
+  }
+
+  ship_contacts.clear();
+  rect ship_bounds = ship.spriteComponent()->getBoundingBox();
+  alien_grid.query(ship_bounds, [&](std::size_t i) {
+    ++collision_pairs;
+    if (aliens[i].visibility &&
+        aliens[i].spriteComponent()->getBoundingBox().isInside(ship_bounds))
+    {
+      ship_contacts.push_back(i);
+    }
+  });
+}
+
+/**
+ *   @brief   Resolves this frame's collisions
+ *   @details Destroys the aliens that were hit and scores them. An
+ *            alien hit by two lasers at once only stops the first.
+ *            The game is lost if an alien still alive reached the
+ *            ship, and won once the whole wave is destroyed.
+ *   @return  void
+ */
+void SpaceInvadersGame::applyCollisions()
+{
+  PERF_COUNT_SCOPE("collision", 0);
+  for (int i = 0; i < shots_max; ++i)
+  {
+    std::size_t hit = laser_hits[static_cast<std::size_t>(i)];
+
+    if (hit < aliens.size() && aliens[hit].visibility)
+    {
+      ship_laser[i].visibility = false;
+      ship_laser[i].spriteComponent()->getSprite()->xPos(
+        ship.spriteComponent()->getSprite()->xPos() + GameRules::MUZZLE_X);
+      ship_laser[i].spriteComponent()->getSprite()->yPos(
+        ship.spriteComponent()->getSprite()->yPos() + GameRules::MUZZLE_Y);
+      aliens[hit].visibility = false;
+      row_dirty[hit / static_cast<std::size_t>(alien_columns)] = 1;
+      score += GameRules::ALIEN_POINTS;
+      aliens_remaining--;
     }
+    else if (ship_laser->spriteComponent()->getSprite()->yPos() <
+             GameRules::LASER_CEILING)
+    {
+      ship_laser[i].visibility = false;
+      ship_laser[i].spriteComponent()->getSprite()->xPos(
+        ship.spriteComponent()->getSprite()->xPos() + GameRules::MUZZLE_X);
+      ship_laser[i].spriteComponent()->getSprite()->yPos(
+        ship.spriteComponent()->getSprite()->yPos() + GameRules::MUZZLE_Y);
+    }
+  }
+
+  for (std::size_t i : ship_contacts)
+  {
+    if (aliens[i].visibility)
+    {
+      playing = false;
+      game_lose = true;
+    }
+  }
+
+  if (aliens_remaining == 0)
+  {
+    game_won = true;
+    playing = false;
   }
 }
@@ -1,45 +1,217 @@
 #pragma once
 #include <Engine/OGLGame.h>
+#include <Engine/Sprite.h>
+#include <array>
+#include <bitset>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "Components/GameObject.h"
+#include "GameSettings.h"
+#include "Simulation/GameRules.h"
+#include "Systems/Broadphase.h"
+#include "Systems/FrameGovernor.h"
+#include "Systems/FramePacer.h"
+#include "Systems/IdleThrottle.h"
+#include "Systems/InputQueue.h"
+#include "Systems/JobSystem.h"
+#include "Systems/LatencyTracker.h"
+#include "Systems/Profiler.h"
+#include "Systems/RenderList.h"
+#include "Systems/SessionTelemetry.h"
+#include "Systems/SharedMetrics.h"
+#include "Systems/SimulationThread.h"
+#include "Systems/SpriteAnimator.h"
+#include "Systems/TaskGraph.h"
+#include "Systems/TripleBuffer.h"
+#include "Utility/Camera.h"
 #include "Utility/Rect.h"
 #include "Utility/Vector2.h"
 
+/**
+ *  The most inputs a step keeps arrival times for. Any more are still
+ *  applied, but only counted by the later stages of the latency report.
+ */
+constexpr std::size_t MAX_STEP_INPUTS = 32;
+
+/**
+ *  Everything the renderer needs to draw a frame.
+ *  Published by the simulation and never changed once published.
+ */
+struct FrameSnapshot
+{
+  std::vector<RenderItem> items;
+  int score = 0;
+  bool in_menu = true;
+  bool movement = false;
+  bool playing = false;
+  bool game_lose = false;
+  bool game_won = false;
+  double critical_path_ms = 0;
+  double span_ms = 0;
+  bool show_frame_graph = false;
+  bool show_profiler = false;
+
+  // arrival times of the input applied in this frame
+  std::array<LatencyTracker::clock::time_point, MAX_STEP_INPUTS> inputs;
+  std::size_t input_count = 0;
+  std::size_t inputs_left_out = 0; /**< Applied, but not timed. */
+};
+
 /**
  *  An OpenGL Game based on ASGE.
  */
 class SpaceInvadersGame : public ASGE::OGLGame
 {
  public:
-  SpaceInvadersGame();
+  explicit SpaceInvadersGame(const GameSettings& settings = GameSettings());
   ~SpaceInvadersGame();
   virtual bool init() override;
+  const PacingStats& pacingStats() const;
+  const LatencyTracker& inputLatency() const;
+  const SessionTelemetry& sessionTelemetry() const;
+  const FrameSnapshot& drawnFrame() const;
+
+ protected:
+  virtual bool openWindow();
+  void finishStep();
 
  private:
   void keyHandler(const ASGE::SharedEventData data);
+  void applyKey(const InputEvent& key);
+  void applyInput();
+  void applyDeferredInput();
   void clickHandler(const ASGE::SharedEventData data);
   void setupResolution();
+  void setupWorld();
+  void setupAnimations();
+  void setupFrameGraph();
+  void setupGovernor();
+  bool setupStamps();
+  bool setupEntities();
   void alienMovement(const ASGE::GameTime& game_time);
+  void moveAlien(std::size_t i, const GameRules::AlienStep& step);
+  void moveRow(std::size_t row, const GameRules::AlienStep& step);
   void shipMovement(const ASGE::GameTime& game_time);
   void laserMovement(const ASGE::GameTime& game_time);
+  void cameraMovement(const ASGE::GameTime& game_time);
+  void findCollisions();
+  void applyCollisions();
+  void updateFormationBounds();
+  void updateAnimation();
+  bool isNearAction(const rect& bounds);
+  void buildBroadphase();
+  void buildRenderList();
+  void submitRenderItem(const RenderItem& item);
+  void recordInputLatency(LatencyTracker::Stage stage);
+  void step();
+  void publishSnapshot();
+  void publishMetrics();
+  bool isStaticScene() const;
+  std::size_t sceneFingerprint() const;
 
   void update(const ASGE::GameTime&) override;
   void render(const ASGE::GameTime&) override;
+  void renderProfiler();
 
   int key_callback_id = -1;   /**< Key Input Callback ID. */
   int mouse_callback_id = -1; /**< Mouse Input Callback ID. */
 
+  static constexpr std::uint8_t ALIEN_LAYER = 0;
+  static constexpr std::uint8_t LASER_LAYER = 1;
+  static constexpr std::uint8_t SHIP_LAYER = 2;
+  static constexpr std::size_t ALIEN_GRAIN = 512;
+  static constexpr std::size_t PROJECTILE_GRAIN = 256;
+  static constexpr std::uint32_t LOD_INTERVAL = 4; /**< Distant row rate. */
+  static constexpr float LOD_NEAR = 210; /**< Rows this close move always. */
+  static constexpr int KEY_CODES = 512;
+  static constexpr int PROFILER_REFRESH = 30; /**< Frames between updates. */
+  static constexpr std::uint64_t TRACE_FRAMES = 300; /**< Traced by a key. */
+  static constexpr std::chrono::duration<double, std::milli>
+    IDLE_RESUME_DELTA{ 1000.0 / 60 }; /**< Simulated on waking. */
+
+  enum SpriteTexture : std::uint8_t
+  {
+    ALIEN_TEXTURE,
+    LASER_TEXTURE,
+    SHIP_TEXTURE,
+    TEXTURE_COUNT
+  };
+
+  /**
+   *  The state shared between the tasks in the frame graph.
+   */
+  enum FrameResource : TaskGraph::ResourceSet
+  {
+    INPUT = 1 << 0,        /**< Key state and the fire request. */
+    CAMERA = 1 << 1,       /**< The camera's view of the world. */
+    SHIP = 1 << 2,         /**< The player's ship. */
+    ALIENS = 1 << 3,       /**< The alien wave and its movement. */
+    LASERS = 1 << 4,       /**< The ship's lasers and shot count. */
+    GRID = 1 << 5,         /**< The alien broadphase grid. */
+    CONTACTS = 1 << 6,     /**< Collisions found this frame. */
+    SCORE = 1 << 7,        /**< Score and win or lose state. */
+    FORMATION = 1 << 8,    /**< Bounds and rate of each row of aliens. */
+    ANIMATION = 1 << 9,    /**< Sprite animation clocks. */
+    RENDER_LIST = 1 << 10, /**< The sorted draw list. */
+    ROW_STATE = 1 << 11    /**< Rows yet to move or be remeasured. */
+  };
+
+  GameSettings settings;
+  JobSystem jobs;
+  RenderList render_list;
+  Broadphase alien_grid{ 128, 70 };
+  IdleThrottle idle_throttle;
+  FramePacer frame_pacer;
+  FrameGovernor governor;
+  Camera camera{ 640, 920 };
+  SpriteAnimator animator;
+  int alien_animation = -1;
+  TaskGraph frame_graph;
+  ASGE::GameTime step_time; /**< The time being simulated. */
+  InputQueue input_queue;
+  std::array<InputEvent, InputQueue::CAPACITY> deferred_input;
+  std::size_t deferred_count = 0;
+  LatencyTracker latency;
+  SessionTelemetry telemetry;
+  std::array<LatencyTracker::clock::time_point, MAX_STEP_INPUTS> step_inputs;
+  std::size_t step_input_count = 0;
+  std::size_t step_inputs_left_out = 0;
+  bool awaiting_present = false; /**< The last frame drawn had input. */
+  TripleBuffer<FrameSnapshot> snapshots;
+  std::array<std::unique_ptr<ASGE::Sprite>, TEXTURE_COUNT> stamps;
+  std::vector<std::string> profiler_lines; /**< The overlay's text. */
+  int profiler_frames = 0;
+  Profiler::clock::time_point render_end{}; /**< Presenting starts here. */
+  double render_ms = 0;     /**< The last render's work, not presenting. */
+  double step_ms = 0;       /**< The last step's work, on its thread. */
+  bool step_kicked = false; /**< A step is yet to be given to the governor. */
+  SharedMetrics metrics;
+  std::uint64_t metrics_frame = 0;
+  std::uint64_t metrics_allocations = 0; /**< As of the last frame. */
+  Profiler::clock::time_point metrics_time{};
+
   // Add your GameObjects
 
   GameObject ship;
-  GameObject aliens[7];
+  std::vector<GameObject> aliens;
   GameObject ship_laser[3];
   GameObject velocity;
 
-  vector2 alien_sine[7] = { vector2(0, 0), vector2(0, 0), vector2(0, 0),
-                            vector2(0, 0), vector2(0, 0), vector2(0, 0),
-                            vector2(0, 0) };
+  std::vector<vector2> alien_sine;
+  std::vector<rect> row_bounds; /**< World bounds of each row of aliens. */
+  std::vector<double> row_pending;        /**< Time a row has yet to move. */
+  std::vector<std::uint8_t> row_full_rate; /**< Rows near the action. */
+  std::vector<std::uint8_t> row_dirty;     /**< Rows moved or hit. */
+  std::uint32_t lod_frame = 0;
+  std::uint32_t lod_interval = LOD_INTERVAL; /**< Set by the governor. */
+  std::uint32_t animation_stride = 1;        /**< Set by the governor. */
+  std::uint32_t animation_frames = 0;
+  double animation_time = 0; /**< Time the animations have yet to run. */
+  std::vector<std::size_t> laser_hits;    /**< Alien hit by each laser. */
+  std::vector<std::size_t> ship_contacts; /**< Aliens touching the ship. */
+  std::size_t collision_pairs = 0; /**< Bounds tested this frame. */
 
   bool in_menu = true;
   bool playing = false;
@@ -50,6 +222,10 @@ class SpaceInvadersGame : public ASGE::OGLGame
   bool fired = false;
   bool alien_left = false;
   bool movement = false;
+  bool camera_up = false;
+  bool camera_down = false;
+  bool show_frame_graph = false;
+  bool show_profiler = false;
 
   int score = 0;
   int shots_max = 3;
@@ -57,4 +233,11 @@ class SpaceInvadersGame : public ASGE::OGLGame
   int aliens_init = 7;
   int aliens_remaining = 7;
   int alien_movement = 0;
+  int alien_columns = 7;
+
+  float world_width = 640;
+  float world_height = 920;
+
+  // started last and stopped first, as it uses everything above
+  SimulationThread simulation{ [this] { step(); } };
 };
\ No newline at end of file
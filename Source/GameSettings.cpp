@@ -0,0 +1,193 @@
+#include "GameSettings.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+/**
+ *   @brief   Builds the settings from the command line.
+ *   @details Supported options:
+ *            --fps N     paces frames to N per second
+ *            --uncapped  removes the frame rate cap
+ *            --idle-timeout MS sleeps at most MS on a static screen
+ *            --no-idle   never sleeps on a static screen
+ *            --screens N the playfield is N screens tall
+ *            --rows N    the wave has N rows of aliens
+ *            --columns N each row has N aliens
+ *            --threads N starts N worker threads
+ *            --trace N   traces the first N frames
+ *            --trace-file PATH writes traces to PATH
+ *            --sample PATH samples call stacks, folded into PATH
+ *            --sample-hz N takes N samples per second of CPU time
+ *            --perf-counters counts each phase's cache misses
+ *            --metrics NAME publishes live metrics to shared memory
+ *            --hitches MS,MS counts frames slower than each MS
+ *            --report PATH also writes the session report to PATH
+ *            --log PATH  appends diagnostics to PATH, or none if empty
+ *            --startup-report PATH also writes the startup times to PATH
+ *
+ *            Headless batch runs also support:
+ *            --movement N    aliens use movement mode N
+ *            --games N       plays N games
+ *            --seed N        seeds the first game with N
+ *            --policy NAME   random, scripted or planner input
+ *            --max-frames N  abandons games after N frames
+ *            --outcomes PATH writes every game's outcome to PATH
+ *            --envs N        steps N games together instead
+ *            --env-steps N   steps them N times
+ *            --budget MS     the planner thinks for MS per choice
+ *   @return  The parsed settings.
+ */
+GameSettings GameSettings::fromArgs(int argc, char* argv[])
+{
+  GameSettings settings;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+
+    if (arg == "--fps" && i + 1 < argc)
+    {
+      settings.target_fps = std::atof(argv[++i]);
+    }
+    else if (arg == "--uncapped")
+    {
+      settings.target_fps = 0;
+    }
+    else if (arg == "--idle-timeout" && i + 1 < argc)
+    {
+      settings.idle_timeout_ms = std::max(1, std::atoi(argv[++i]));
+    }
+    else if (arg == "--no-idle")
+    {
+      settings.idle_throttle = false;
+    }
+    else if (arg == "--screens" && i + 1 < argc)
+    {
+      settings.screens = std::max(1, std::atoi(argv[++i]));
+    }
+    else if (arg == "--rows" && i + 1 < argc)
+    {
+      settings.alien_rows = std::max(1, std::atoi(argv[++i]));
+    }
+    else if (arg == "--columns" && i + 1 < argc)
+    {
+      settings.alien_columns = std::max(1, std::atoi(argv[++i]));
+    }
+    else if (arg == "--threads" && i + 1 < argc)
+    {
+      settings.worker_threads = std::max(0, std::atoi(argv[++i]));
+    }
+    else if (arg == "--trace" && i + 1 < argc)
+    {
+      settings.trace_frames = std::strtoull(argv[++i], nullptr, 10);
+    }
+    else if (arg == "--trace-file" && i + 1 < argc)
+    {
+      settings.trace_file = argv[++i];
+    }
+    else if (arg == "--sample" && i + 1 < argc)
+    {
+      settings.sample_file = argv[++i];
+    }
+    else if (arg == "--sample-hz" && i + 1 < argc)
+    {
+      settings.sample_hz = std::max(1, std::atoi(argv[++i]));
+    }
+    else if (arg == "--perf-counters")
+    {
+      settings.perf_counters = true;
+    }
+    else if (arg == "--metrics" && i + 1 < argc)
+    {
+      settings.metrics_name = argv[++i];
+    }
+    else if (arg == "--hitches" && i + 1 < argc)
+    {
+      settings.hitch_ms.clear();
+      for (const char* list = argv[++i]; *list != '\0';)
+      {
+        char* end = nullptr;
+        double hitch = std::strtod(list, &end);
+        if (end == list)
+        {
+          break;
+        }
+        settings.hitch_ms.push_back(hitch);
+        list = *end == ',' ? end + 1 : end;
+      }
+    }
+    else if (arg == "--report" && i + 1 < argc)
+    {
+      settings.report_file = argv[++i];
+    }
+    else if (arg == "--log" && i + 1 < argc)
+    {
+      settings.log_file = argv[++i];
+    }
+    else if (arg == "--startup-report" && i + 1 < argc)
+    {
+      settings.startup_report = argv[++i];
+    }
+    else if (arg == "--movement" && i + 1 < argc)
+    {
+      settings.movement = std::min(4, std::max(1, std::atoi(argv[++i])));
+    }
+    else if (arg == "--games" && i + 1 < argc)
+    {
+      settings.games = std::strtoull(argv[++i], nullptr, 10);
+    }
+    else if (arg == "--seed" && i + 1 < argc)
+    {
+      settings.seed = std::strtoull(argv[++i], nullptr, 10);
+    }
+    else if (arg == "--policy" && i + 1 < argc)
+    {
+      settings.policy = argv[++i];
+    }
+    else if (arg == "--max-frames" && i + 1 < argc)
+    {
+      settings.max_frames = std::max(1, std::atoi(argv[++i]));
+    }
+    else if (arg == "--outcomes" && i + 1 < argc)
+    {
+      settings.outcomes = argv[++i];
+    }
+    else if (arg == "--envs" && i + 1 < argc)
+    {
+      settings.envs = std::strtoull(argv[++i], nullptr, 10);
+    }
+    else if (arg == "--env-steps" && i + 1 < argc)
+    {
+      settings.env_steps = std::strtoull(argv[++i], nullptr, 10);
+    }
+    else if (arg == "--budget" && i + 1 < argc)
+    {
+      settings.plan_budget_ms = std::max(0.0, std::atof(argv[++i]));
+    }
+    else
+    {
+      std::cerr << "Ignoring unknown option: " << arg << std::endl;
+    }
+  }
+
+  return settings;
+}
+
+/**
+ *   @brief   Gets the number of worker threads.
+ *   @details Unless overridden, one worker is started for every core
+ *            other than the one running the main thread.
+ *   @return  The number of worker threads to start.
+ */
+unsigned int GameSettings::workerThreads() const
+{
+  if (worker_threads >= 0)
+  {
+    return static_cast<unsigned int>(worker_threads);
+  }
+
+  unsigned int cores = std::thread::hardware_concurrency();
+  return cores > 1 ? cores - 1 : 0;
+}
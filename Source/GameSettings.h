@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ *  Start-up options for the game.
+ *  Populated from the command line so cabinets and benchmark runs
+ *  can be configured without rebuilding.
+ */
+struct GameSettings
+{
+  /**
+   *  Parses the command line.
+   *  Unrecognised arguments are reported and otherwise ignored.
+   *  @param [in] argc The number of arguments
+   *  @param [in] argv The argument strings
+   *  @return the settings with any overrides applied
+   */
+  static GameSettings fromArgs(int argc, char* argv[]);
+
+  /**
+   *  Gets the number of worker threads to start.
+   *  @return the requested count, or one per spare core if unset
+   */
+  unsigned int workerThreads() const;
+
+  double target_fps = 60; /**< Frame rate to pace to, zero for uncapped. */
+  int idle_timeout_ms = 250; /**< Longest sleep on a static screen. */
+  bool idle_throttle = true; /**< Sleeps on static screens. */
+  int screens = 1;        /**< Height of the playfield in screens. */
+  int alien_rows = 1;     /**< Rows of aliens in the invasion wave. */
+  int alien_columns = 7;  /**< Aliens in each row of the wave. */
+  int worker_threads = -1; /**< Threads besides the main one, -1 for auto. */
+  std::uint64_t trace_frames = 0;     /**< Frames to trace from launch. */
+  std::string trace_file = "trace.json"; /**< Where traces are written. */
+  std::string sample_file; /**< Folded stacks file, empty to not sample. */
+  int sample_hz = 499;     /**< Stack samples per second of CPU time. */
+  bool perf_counters = false; /**< Counts each phase with the hardware. */
+  std::string metrics_name; /**< Shared memory for monitors, if set. */
+  std::vector<double> hitch_ms{ 20, 33.3, 50, 100 }; /**< Slow frames. */
+  std::string report_file; /**< Session report file, as well as stdout. */
+  std::string log_file = "game.log"; /**< Diagnostics, empty for none. */
+  std::string startup_report; /**< Startup report file, and stdout. */
+
+  // headless batch runs only
+  int movement = 1;            /**< Alien movement mode, from 1 to 4. */
+  std::size_t games = 1000;    /**< Games to play. */
+  std::uint64_t seed = 1;      /**< Seed of the first game. */
+  std::string policy = "random"; /**< random, scripted or planner. */
+  int max_frames = 36000;      /**< Frames before a game is abandoned. */
+  std::string outcomes;        /**< CSV file for every game's outcome. */
+  std::size_t envs = 0;        /**< Games stepped together, 0 for batches. */
+  std::size_t env_steps = 10000; /**< Steps taken over every game. */
+  double plan_budget_ms = 2;   /**< Planning time for each choice. */
+};
@@ -0,0 +1,158 @@
+#include "Systems/SharedMetrics.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <unistd.h>
+#endif
+
+namespace
+{
+  const MetricsSegment* mapSegment(const std::string& name)
+  {
+#ifdef __linux__
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+    {
+      return nullptr;
+    }
+
+    void* memory = mmap(
+      nullptr, sizeof(MetricsSegment), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED)
+    {
+      return nullptr;
+    }
+
+    const auto* segment = static_cast<const MetricsSegment*>(memory);
+    std::uint32_t magic = segment->magic;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (magic != SharedMetrics::MAGIC ||
+        segment->version != SharedMetrics::VERSION ||
+        segment->size != sizeof(MetricsSegment))
+    {
+      std::cerr << name << " isn't a version " << SharedMetrics::VERSION
+                << " metrics segment" << std::endl;
+      munmap(memory, sizeof(MetricsSegment));
+      return nullptr;
+    }
+
+    return segment;
+#else
+    (void)name;
+    return nullptr;
+#endif
+  }
+
+  const char* stateOf(const MetricsFrame& frame)
+  {
+    if (frame.in_menu)
+    {
+      return "menu";
+    }
+    if (frame.movement)
+    {
+      return "choosing movement";
+    }
+    if (frame.playing)
+    {
+      return "playing";
+    }
+    if (frame.game_won)
+    {
+      return "won";
+    }
+    return frame.game_lose ? "lost" : "idle";
+  }
+
+  void print(const MetricsFrame& frame)
+  {
+    std::cout << "Frame " << frame.frame << ": " << frame.frame_ms
+              << "ms, graph " << frame.graph_ms << "ms, "
+              << stateOf(frame) << ", score " << frame.score << '\n';
+    std::cout << "  aliens " << frame.aliens_alive << '/'
+              << frame.aliens_total << ", lasers " << frame.lasers_live
+              << ", collision pairs " << frame.collision_pairs
+              << ", allocations " << frame.frame_allocations << " ("
+              << frame.allocations << " total)\n";
+
+    for (std::uint32_t i = 0;
+         i < frame.phase_count && i < MetricsFrame::MAX_PHASES;
+         ++i)
+    {
+      const MetricsFrame::Phase& phase = frame.phases[i];
+      std::string name(phase.name,
+                       strnlen(phase.name, MetricsFrame::NAME_LENGTH));
+      std::cout << "  " << name << ' ' << phase.ms << "ms\n";
+    }
+    std::cout << std::flush;
+  }
+}
+
+/**
+ *   @brief   Watches a running game's live metrics.
+ *   @details Supported options:
+ *            --name NAME   reads the segment the game published as NAME
+ *            --interval MS prints the latest frame every MS
+ *            --once        prints a single frame and exits
+ *   @return  Zero, or one if the segment couldn't be opened.
+ */
+int main(int argc, char* argv[])
+{
+  std::string name = "/space-invaders";
+  int interval_ms = 500;
+  bool once = false;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+
+    if (arg == "--name" && i + 1 < argc)
+    {
+      name = argv[++i];
+    }
+    else if (arg == "--interval" && i + 1 < argc)
+    {
+      interval_ms = std::max(1, std::atoi(argv[++i]));
+    }
+    else if (arg == "--once")
+    {
+      once = true;
+    }
+    else
+    {
+      std::cerr << "Ignoring unknown option: " << arg << std::endl;
+    }
+  }
+
+  const MetricsSegment* segment = mapSegment(name);
+  if (segment == nullptr)
+  {
+    std::cerr << "No metrics published as " << name << std::endl;
+    return 1;
+  }
+
+  while (true)
+  {
+    // a frame caught mid-write is simply skipped until the next look
+    MetricsFrame frame;
+    if (SharedMetrics::read(*segment, frame))
+    {
+      print(frame);
+      if (once)
+      {
+        return 0;
+      }
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+  }
+}
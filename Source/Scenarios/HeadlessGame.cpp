@@ -0,0 +1,78 @@
+#include "HeadlessGame.h"
+#include "Bench/HeadlessRenderer.h"
+#include <Engine/InputEvents.h>
+#include <Engine/Keys.h>
+
+HeadlessGame::HeadlessGame(const GameSettings& settings) :
+  SpaceInvadersGame(settings)
+{
+  time.delta = std::chrono::duration<double, std::milli>(0);
+  time.elapsed = std::chrono::milliseconds(0);
+}
+
+bool HeadlessGame::init()
+{
+  if (!SpaceInvadersGame::init())
+  {
+    return false;
+  }
+
+  inputs->use_threads = false;
+  return true;
+}
+
+/**
+ *   @brief   Creates the headless renderer and input
+ *   @details Stands in for the window and GL context. The textures
+ *            the game loads are given their real sizes, as the lasers
+ *            are sized by theirs.
+ *   @return  True, as nothing can fail.
+ */
+bool HeadlessGame::openWindow()
+{
+  auto headless = std::make_unique<HeadlessRenderer>();
+  headless->addTexture("data/Textures/spritesheet_spaceships.png", 512, 512);
+  headless->addTexture("data/Textures/laserRed01.png", 9, 54);
+  headless->addTexture("data/Textures/playerShip1_red.png", 99, 75);
+
+  inputs = headless->inputPtr();
+  renderer = std::move(headless);
+  return true;
+}
+
+/**
+ *   @brief   Updates and renders one frame
+ *   @details The frame's time advances by the delta, not the clock,
+ *            so the simulation is the same however long frames take.
+ *            The frame's step is finished before returning, so keys
+ *            sent between frames always reach the next step.
+ *   @return  void
+ */
+void HeadlessGame::frame(double delta_ms)
+{
+  simulated_ms += delta_ms;
+  time.delta = std::chrono::duration<double, std::milli>(delta_ms);
+  time.frame_time = std::chrono::steady_clock::now();
+  time.elapsed = std::chrono::milliseconds(
+    static_cast<std::chrono::milliseconds::rep>(simulated_ms));
+
+  ASGE::Game& game = *this;
+  game.update(time);
+  game.render(time);
+  finishStep();
+}
+
+void HeadlessGame::key(int key, int action)
+{
+  auto event = std::make_shared<ASGE::KeyEvent>();
+  event->key = key;
+  event->action = action;
+  event->mods = 0;
+  inputs->sendEvent(ASGE::E_KEY, event);
+}
+
+void HeadlessGame::tap(int key)
+{
+  this->key(key, ASGE::KEYS::KEY_PRESSED);
+  this->key(key, ASGE::KEYS::KEY_RELEASED);
+}
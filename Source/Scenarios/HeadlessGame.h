@@ -0,0 +1,51 @@
+#pragma once
+#include "Game.h"
+#include <Engine/GameTime.h>
+
+/**
+ *  The real game, run without a window.
+ *  The renderer and input are swapped for headless ones before the
+ *  game is set up, so every update and render runs as it does in the
+ *  windowed game, minus the GPU. Frames are stepped by hand with a
+ *  fixed delta and keys are sent as events, so a script of inputs
+ *  plays out the same way on every run.
+ */
+class HeadlessGame : public SpaceInvadersGame
+{
+ public:
+  explicit HeadlessGame(const GameSettings& settings);
+
+  /**
+   *  Sets the game up.
+   *  Keys are then handled as they are sent rather than on a thread,
+   *  so each reaches the step that follows it.
+   *  @return true if the game initialised correctly
+   */
+  bool init() override;
+
+  /**
+   *  Updates and renders one frame.
+   *  @param [in] delta_ms The time the frame simulates
+   */
+  void frame(double delta_ms);
+
+  /**
+   *  Sends a key event to the game.
+   *  @param [in] key The key, from ASGE::KEYS
+   *  @param [in] action Pressed or released, from ASGE::KEYS
+   */
+  void key(int key, int action);
+
+  /**
+   *  Sends a key being pressed and then released.
+   *  @param [in] key The key, from ASGE::KEYS
+   */
+  void tap(int key);
+
+ protected:
+  bool openWindow() override;
+
+ private:
+  ASGE::GameTime time;
+  double simulated_ms = 0;
+};
@@ -0,0 +1,390 @@
+#include "GameSettings.h"
+#include "Scenarios/HeadlessGame.h"
+#include "Systems/AllocationCounter.h"
+#include "Systems/HdrHistogram.h"
+#include "Systems/SessionTelemetry.h"
+#include <Engine/Keys.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+  // bump whenever the JSON's layout changes
+  constexpr int JSON_FORMAT = 1;
+  constexpr double FRAME_MS = 1000.0 / 60.0;
+
+  using clock = std::chrono::steady_clock;
+
+  /**
+   *  A scripted run of the game.
+   *  The script is called before every frame with the frame's number
+   *  and sends whatever keys that frame should see.
+   */
+  struct Scenario
+  {
+    std::string name;
+    int rows = 1;
+    int columns = 7;
+    int frames = 600;        /**< Frames to run, unless it ends first. */
+    bool until_over = false; /**< Stops once the game is won or lost. */
+    std::function<void(HeadlessGame&, int)> script;
+  };
+
+  struct ScenarioResult
+  {
+    std::string name;
+    int aliens = 0;
+    int frames = 0;
+    double setup_ms = 0;
+    double run_ms = 0;
+    HdrHistogram frame_us;
+    std::uint64_t allocations = 0;
+    long peak_rss_kb = 0;
+    int score = 0;
+    std::string outcome;
+  };
+
+  /**
+   *  Starts measuring the peak resident memory afresh.
+   *  @return false if only the peak since launch can be measured
+   */
+  bool resetPeakRss()
+  {
+#ifdef __linux__
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5";
+    clear_refs.flush();
+    return static_cast<bool>(clear_refs);
+#else
+    return false;
+#endif
+  }
+
+  long peakRssKb()
+  {
+#ifdef __linux__
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+    {
+      if (line.compare(0, 6, "VmHWM:") == 0)
+      {
+        return std::atol(line.c_str() + 6);
+      }
+    }
+#endif
+    return SessionTelemetry::peakRssKb();
+  }
+
+  const char* outcomeOf(const FrameSnapshot& frame)
+  {
+    if (frame.in_menu)
+    {
+      return "menu";
+    }
+    if (frame.movement)
+    {
+      return "choosing movement";
+    }
+    if (frame.playing)
+    {
+      return "playing";
+    }
+    if (frame.game_won)
+    {
+      return "won";
+    }
+    return frame.game_lose ? "lost" : "idle";
+  }
+
+  /**
+   *  Leaves the menu and picks a movement mode on the first frames.
+   */
+  void start(HeadlessGame& game, int frame, int mode)
+  {
+    if (frame == 0)
+    {
+      game.tap(ASGE::KEYS::KEY_ENTER);
+    }
+    else if (frame == 1)
+    {
+      game.tap(ASGE::KEYS::KEY_1 + mode - 1);
+    }
+  }
+
+  /**
+   *  Sweeps the ship from side to side, firing every few frames.
+   */
+  void sweepAndFire(HeadlessGame& game, int frame)
+  {
+    if (frame % 180 == 2)
+    {
+      game.key(ASGE::KEYS::KEY_A, ASGE::KEYS::KEY_RELEASED);
+      game.key(ASGE::KEYS::KEY_D, ASGE::KEYS::KEY_PRESSED);
+    }
+    else if (frame % 180 == 92)
+    {
+      game.key(ASGE::KEYS::KEY_D, ASGE::KEYS::KEY_RELEASED);
+      game.key(ASGE::KEYS::KEY_A, ASGE::KEYS::KEY_PRESSED);
+    }
+
+    if (frame > 2 && frame % 6 == 0)
+    {
+      game.tap(ASGE::KEYS::KEY_SPACE);
+    }
+  }
+
+  std::vector<Scenario> scenarios()
+  {
+    std::vector<Scenario> all;
+
+    Scenario menu;
+    menu.name = "menu_to_play";
+    menu.frames = 240;
+    menu.script = [](HeadlessGame& game, int frame) {
+      if (frame == 60)
+      {
+        game.tap(ASGE::KEYS::KEY_ENTER);
+      }
+      else if (frame == 90)
+      {
+        game.tap(ASGE::KEYS::KEY_1);
+      }
+    };
+    all.push_back(menu);
+
+    // the wider waves are 8 aliens across
+    const std::vector<std::pair<int, int>> waves{
+      { 1, 7 }, { 125, 8 }, { 1250, 8 }, { 12500, 8 }
+    };
+    for (int mode = 1; mode <= 4; ++mode)
+    {
+      for (const auto& wave : waves)
+      {
+        Scenario movement;
+        movement.name = "movement/mode" + std::to_string(mode) + "/" +
+                        std::to_string(wave.first * wave.second);
+        movement.rows = wave.first;
+        movement.columns = wave.second;
+        movement.script = [mode](HeadlessGame& game, int frame) {
+          start(game, frame, mode);
+        };
+        all.push_back(movement);
+      }
+    }
+
+    Scenario fire;
+    fire.name = "constant_fire/1000";
+    fire.rows = 125;
+    fire.columns = 8;
+    fire.script = [](HeadlessGame& game, int frame) {
+      start(game, frame, 1);
+      sweepAndFire(game, frame);
+    };
+    all.push_back(fire);
+
+    Scenario clear;
+    clear.name = "wave_clear/7";
+    clear.frames = 7200;
+    clear.until_over = true;
+    clear.script = fire.script;
+    all.push_back(clear);
+
+    return all;
+  }
+
+  /**
+   *   @brief   Runs a scenario from launch to its last frame
+   *   @details Only the frames are timed and counted, not setting the
+   *            game up or tearing it down.
+   *   @return  The scenario's measurements.
+   */
+  ScenarioResult run(const Scenario& scenario, GameSettings settings)
+  {
+    settings.alien_rows = scenario.rows;
+    settings.alien_columns = scenario.columns;
+
+    ScenarioResult result;
+    result.name = scenario.name;
+    result.aliens = scenario.rows * scenario.columns;
+
+    clock::time_point setup_start = clock::now();
+    HeadlessGame game(settings);
+    if (!game.init())
+    {
+      result.outcome = "failed to initialise";
+      return result;
+    }
+    result.setup_ms = std::chrono::duration<double, std::milli>(
+                        clock::now() - setup_start)
+                        .count();
+
+    resetPeakRss();
+    std::uint64_t allocations = AllocationCounter::count();
+    clock::time_point run_start = clock::now();
+
+    for (int frame = 0; frame < scenario.frames; ++frame)
+    {
+      scenario.script(game, frame);
+
+      clock::time_point frame_start = clock::now();
+      game.frame(FRAME_MS);
+      std::chrono::duration<double, std::micro> took =
+        clock::now() - frame_start;
+      result.frame_us.record(static_cast<std::uint64_t>(took.count()));
+      ++result.frames;
+
+      const FrameSnapshot& drawn = game.drawnFrame();
+      if (scenario.until_over && (drawn.game_won || drawn.game_lose))
+      {
+        break;
+      }
+    }
+
+    result.run_ms =
+      std::chrono::duration<double, std::milli>(clock::now() - run_start)
+        .count();
+    result.allocations = AllocationCounter::count() - allocations;
+    result.peak_rss_kb = peakRssKb();
+    result.score = game.drawnFrame().score;
+    result.outcome = outcomeOf(game.drawnFrame());
+    return result;
+  }
+
+  void writeMs(std::ostream& out, const char* key, double ms)
+  {
+    char text[64];
+    std::snprintf(text, sizeof(text), "\"%s\": %.3f", key, ms);
+    out << text;
+  }
+
+  /**
+   *  Writes every result as JSON, with keys always in the same order.
+   */
+  void writeJson(std::ostream& out,
+                 const std::vector<ScenarioResult>& results,
+                 bool peak_per_scenario)
+  {
+    out << "{\n";
+    out << "  \"format\": " << JSON_FORMAT << ",\n";
+    out << "  \"delta_ms\": " << FRAME_MS << ",\n";
+    out << "  \"peak_rss\": \""
+        << (peak_per_scenario ? "scenario" : "process") << "\",\n";
+    out << "  \"scenarios\": [";
+
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+      const ScenarioResult& result = results[i];
+      const HdrHistogram& frames = result.frame_us;
+      double seconds = result.run_ms / 1000.0;
+
+      out << (i == 0 ? "\n" : ",\n");
+      out << "    {\n";
+      out << "      \"name\": \"" << result.name << "\",\n";
+      out << "      \"aliens\": " << result.aliens << ",\n";
+      out << "      \"frames\": " << result.frames << ",\n";
+      out << "      \"outcome\": \"" << result.outcome << "\",\n";
+      out << "      \"score\": " << result.score << ",\n";
+      out << "      ";
+      writeMs(out, "setup_ms", result.setup_ms);
+      out << ",\n      ";
+      writeMs(out, "fps", seconds > 0 ? result.frames / seconds : 0);
+      out << ",\n";
+      out << "      \"frame_ms\": { ";
+      writeMs(out, "mean", frames.mean() / 1000.0);
+      for (double percentile : { 50.0, 90.0, 99.0, 99.9 })
+      {
+        char key[16];
+        std::snprintf(key, sizeof(key), "p%g", percentile);
+        out << ", ";
+        writeMs(out,
+                key,
+                double(frames.percentile(percentile / 100.0)) / 1000.0);
+      }
+      out << ", ";
+      writeMs(out, "max", double(frames.max()) / 1000.0);
+      out << " },\n";
+      out << "      \"allocations\": " << result.allocations << ",\n";
+      out << "      ";
+      writeMs(out,
+              "allocations_per_frame",
+              result.frames > 0
+                ? double(result.allocations) / double(result.frames)
+                : 0);
+      out << ",\n";
+      out << "      \"peak_rss_kb\": " << result.peak_rss_kb << "\n";
+      out << "    }";
+    }
+
+    out << (results.empty() ? "]\n" : "\n  ]\n");
+    out << "}\n";
+  }
+}
+
+/**
+ *   @brief   Runs the end to end scenarios
+ *   @details Every game option is supported, such as --threads, as
+ *            well as:
+ *            --filter TEXT     only runs scenarios named with TEXT
+ *            --out PATH        writes the JSON to PATH, not stdout
+ *
+ *            Frames are never paced or throttled and nothing is
+ *            logged, whatever the options say.
+ *   @return  0 once every scenario has run.
+ */
+int main(int argc, char* argv[])
+{
+  std::string filter;
+  std::string out_file;
+  std::vector<char*> game_args{ argv[0] };
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg == "--filter" && i + 1 < argc)
+    {
+      filter = argv[++i];
+    }
+    else if (arg == "--out" && i + 1 < argc)
+    {
+      out_file = argv[++i];
+    }
+    else
+    {
+      game_args.push_back(argv[i]);
+    }
+  }
+
+  GameSettings settings = GameSettings::fromArgs(
+    static_cast<int>(game_args.size()), game_args.data());
+  settings.target_fps = 0;
+  settings.idle_throttle = false;
+  settings.log_file.clear();
+  settings.metrics_name.clear();
+  settings.trace_frames = 0;
+
+  std::vector<ScenarioResult> results;
+  for (const Scenario& scenario : scenarios())
+  {
+    if (filter.empty() || scenario.name.find(filter) != std::string::npos)
+    {
+      std::cerr << "Running " << scenario.name << std::endl;
+      results.push_back(run(scenario, settings));
+    }
+  }
+
+  bool peak_per_scenario = resetPeakRss();
+  if (out_file.empty())
+  {
+    writeJson(std::cout, results, peak_per_scenario);
+    return 0;
+  }
+
+  std::ofstream out(out_file);
+  writeJson(out, results, peak_per_scenario);
+  return out ? 0 : 1;
+}
@@ -0,0 +1,87 @@
+#include "BatchRunner.h"
+#include <chrono>
+
+/**
+ *   @brief   Constructor.
+ */
+BatchRunner::BatchRunner(JobSystem& job_system, const Simulation& rules) :
+  jobs(job_system), simulation(rules)
+{
+}
+
+/**
+ *   @brief   Plays a batch of games
+ *   @details Games are shared out between the worker threads a few
+ *            at a time. Every game is played to the end before the
+ *            next one starts, keeping its state hot in the cache.
+ *   @return  The summary of the batch.
+ */
+BatchReport BatchRunner::run(std::size_t games,
+                             std::uint64_t first_seed,
+                             InputPolicy::Kind policy,
+                             std::uint32_t max_frames)
+{
+  results.assign(games, GameOutcome());
+  auto start = std::chrono::steady_clock::now();
+
+  auto play = [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      GameOutcome& outcome = results[i];
+      outcome.seed = first_seed + i;
+
+      SimState state;
+      simulation.reset(state);
+      InputPolicy input(policy, outcome.seed);
+
+      while (state.frame < max_frames && !Simulation::isOver(state))
+      {
+        simulation.step(state, input.actions(state));
+      }
+
+      outcome.score = state.score;
+      outcome.frames = state.frame;
+      outcome.won = state.game_won;
+      outcome.lost = state.game_lose;
+    }
+  };
+  jobs.parallelFor(0, games, GAME_GRAIN, play);
+
+  std::chrono::duration<double> elapsed =
+    std::chrono::steady_clock::now() - start;
+
+  BatchReport report;
+  report.games = games;
+  report.seconds = elapsed.count();
+  report.threads = jobs.concurrency();
+
+  for (const GameOutcome& outcome : results)
+  {
+    report.wins += outcome.won ? 1 : 0;
+    report.losses += outcome.lost ? 1 : 0;
+    report.mean_score += outcome.score;
+    report.mean_frames += outcome.frames;
+  }
+
+  report.abandoned = games - report.wins - report.losses;
+  if (games > 0)
+  {
+    report.mean_score /= double(games);
+    report.mean_frames /= double(games);
+  }
+  if (report.seconds > 0)
+  {
+    report.games_per_second = double(games) / report.seconds;
+  }
+
+  return report;
+}
+
+/**
+ *   @brief   Gets the outcome of every game in the last batch.
+ *   @return  The outcomes, in seed order.
+ */
+const std::vector<GameOutcome>& BatchRunner::outcomes() const
+{
+  return results;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "InputPolicy.h"
+#include "Simulation.h"
+#include "Systems/JobSystem.h"
+
+/**
+ *  How a single headless game ended.
+ */
+struct GameOutcome
+{
+  std::uint64_t seed = 0;
+  int score = 0;
+  std::uint32_t frames = 0; /**< Frames survived. */
+  bool won = false;
+  bool lost = false; /**< Neither won nor lost means abandoned. */
+};
+
+/**
+ *  A summary of a batch of games.
+ */
+struct BatchReport
+{
+  std::size_t games = 0;
+  std::size_t wins = 0;
+  std::size_t losses = 0;
+  std::size_t abandoned = 0;
+  double mean_score = 0;
+  double mean_frames = 0;
+  double seconds = 0;
+  double games_per_second = 0;
+  std::size_t threads = 0;
+};
+
+/**
+ *  Plays many independent headless games across every core.
+ *  Each game lives entirely on the stack of the job playing it, with its
+ *  own state and input policy, and writes only its own outcome. Nothing
+ *  mutable is shared between games, so throughput scales with threads.
+ */
+class BatchRunner
+{
+ public:
+  /**
+   *  Constructor.
+   *  @param [in] job_system The threads used to play games
+   *  @param [in] rules The simulation shared, read-only, by every game
+   */
+  BatchRunner(JobSystem& job_system, const Simulation& rules);
+
+  /**
+   *  Plays a batch of games.
+   *  Game i is seeded with first_seed + i, so batches are repeatable.
+   *  @param [in] games The number of games to play
+   *  @param [in] first_seed The seed of the first game
+   *  @param [in] policy How every game's input is chosen
+   *  @param [in] max_frames Games still running after this are abandoned
+   *  @return the summary of the batch
+   */
+  BatchReport run(std::size_t games,
+                  std::uint64_t first_seed,
+                  InputPolicy::Kind policy,
+                  std::uint32_t max_frames);
+
+  /**
+   *  Gets the outcome of every game in the last batch.
+   *  @return the outcomes, in seed order
+   */
+  const std::vector<GameOutcome>& outcomes() const;
+
+ private:
+  static constexpr std::size_t GAME_GRAIN = 8;
+
+  JobSystem& jobs;
+  const Simulation& simulation;
+  std::vector<GameOutcome> results;
+};
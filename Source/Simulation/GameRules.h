@@ -0,0 +1,213 @@
+#pragma once
+#include <cmath>
+
+/**
+ *  The rules of the game, shared by the windowed game and the headless
+ *  simulation so the two can never drift apart.
+ *  Distances are in pixels and times in milliseconds. The moves are
+ *  defined inline so loops over a whole wave can be vectorised.
+ */
+struct GameRules
+{
+  static constexpr float SCREEN_WIDTH = 640;
+  static constexpr float SCREEN_HEIGHT = 920;
+  static constexpr float ALIEN_SIZE = 70;
+  static constexpr float SHIP_SIZE = 70;
+  static constexpr float LASER_WIDTH = 9;
+  static constexpr float LASER_HEIGHT = 54;
+
+  static constexpr float ALIEN_SPEED = 60;
+  static constexpr float SHIP_SPEED = 600;
+  static constexpr float LASER_SPEED = 200;
+
+  static constexpr float WAVE_TOP = 100;      /**< Top of the first row. */
+  static constexpr float SHIP_RISE = 220;     /**< Ship's height off floor. */
+  static constexpr float MUZZLE_X = 36;       /**< Laser spawn from ship. */
+  static constexpr float MUZZLE_Y = -46;      /**< Laser spawn from ship. */
+  static constexpr float LASER_CEILING = 100; /**< Lasers above this reset. */
+  static constexpr int SHOTS = 3;
+  static constexpr int ALIEN_POINTS = 10;
+
+  /**
+   *  How the alien wave moves on a single frame.
+   */
+  struct AlienStep
+  {
+    int mode = 0;          /**< The movement mode picked on the menu. */
+    float direction = 1;   /**< -1 when the wave heads left. */
+    double delta_time = 0; /**< The frame's length. */
+    bool advance = true;   /**< False on the frame the wave drops. */
+    float world_width = SCREEN_WIDTH;
+  };
+
+  /**
+   *  Moves a single alien.
+   *  @param [in] step How the wave moves this frame
+   *  @param [in,out] x The alien's position
+   *  @param [in,out] y The alien's position
+   *  @param [in] width The alien's size
+   *  @param [in] height The alien's size
+   *  @param [in] sine_x The alien's offset in the sine movement mode
+   */
+  static void moveAlien(const AlienStep& step,
+                        float& x,
+                        float& y,
+                        float width,
+                        float height,
+                        float sine_x);
+
+  /**
+   *  Gets how far the wave moves sideways in a length of time.
+   *  @param [in] direction -1 when the wave heads left
+   *  @param [in] delta_time The length of time
+   *  @return the distance, negative to the left
+   */
+  static float alienAdvance(float direction, double delta_time);
+
+  /**
+   *  Has a row of the wave reached the edge it is heading for?
+   *  A row can be behind on time it has yet to move, which is added to
+   *  its position first, so it turns when it would have at full rate.
+   *  @param [in] step How the wave moves this frame
+   *  @param [in] x The left of the row's bounds
+   *  @param [in] length The width of the row's bounds, zero if empty
+   *  @param [in] pending_time Time the row has yet to move
+   *  @return true if the row is at or past the edge
+   */
+  static bool rowAtEdge(const AlienStep& step,
+                        float x,
+                        float length,
+                        double pending_time);
+
+  /**
+   *  Moves the player's ship.
+   *  Reaching the edge of the playfield cancels the move in that
+   *  direction, so the key has to be pressed again.
+   *  @param [in,out] x The ship's position
+   *  @param [in] width The ship's width
+   *  @param [in] world_width The width of the playfield
+   *  @param [in,out] left Whether the ship is moving left
+   *  @param [in,out] right Whether the ship is moving right
+   *  @param [in] delta_time The frame's length
+   */
+  static void moveShip(float& x,
+                       float width,
+                       float world_width,
+                       bool& left,
+                       bool& right,
+                       double delta_time);
+};
+
+/**
+ *   @brief   Moves a single alien
+ *   @details Only touches the alien it is given, so it is safe to
+ *            call for different aliens from different threads. The
+ *            wave doesn't advance sideways on the frame it drops.
+ *   @return  void
+ */
+inline void GameRules::moveAlien(const AlienStep& step,
+                                 float& x,
+                                 float& y,
+                                 float width,
+                                 float height,
+                                 float sine_x)
+{
+  double delta_time = step.delta_time;
+
+  if (step.advance)
+  {
+    x += alienAdvance(step.direction, delta_time);
+  }
+
+  if (step.mode == 2)
+  {
+    y += static_cast<float>(9.8f * y * delta_time / 100000.f);
+  }
+  else if (step.mode == 3)
+  {
+    float middle_x = step.world_width / 2 - (width / 2);
+    float offset = x - middle_x;
+
+    y = (-1 * offset / 20 * offset / 20 + height * 4);
+  }
+  else if (step.mode == 4)
+  {
+    x = sine_x +
+        step.direction *
+          (100.f * static_cast<float>(
+                     sin(static_cast<long double>(delta_time)) / 150)) +
+        x;
+
+    y += static_cast<float>(30 * (delta_time / 1000.f));
+  }
+}
+
+/**
+ *   @brief   Gets how far the wave moves sideways
+ *   @details The sine mode's sway is on top of this.
+ *   @return  The distance in pixels.
+ */
+inline float GameRules::alienAdvance(float direction, double delta_time)
+{
+  return ALIEN_SPEED * direction * static_cast<float>(delta_time / 1000.f);
+}
+
+/**
+ *   @brief   Has a row reached the edge it is heading for?
+ *   @details The right edge is reached once the row's last alien
+ *            starts past it. Empty rows never reach an edge.
+ *   @return  True if the wave should turn.
+ */
+inline bool GameRules::rowAtEdge(const AlienStep& step,
+                                 float x,
+                                 float length,
+                                 double pending_time)
+{
+  if (length <= 0)
+  {
+    return false;
+  }
+
+  x += alienAdvance(step.direction, pending_time);
+  float right = x + length - ALIEN_SIZE;
+  return step.direction < 0 ? x <= 0 : right >= step.world_width;
+}
+
+/**
+ *   @brief   Moves the player's ship
+ *   @details Left is applied before right, so holding both cancels
+ *            out unless the ship is against an edge. The right edge
+ *            is checked after any move to the left.
+ *   @return  void
+ */
+inline void GameRules::moveShip(float& x,
+                                float width,
+                                float world_width,
+                                bool& left,
+                                bool& right,
+                                double delta_time)
+{
+  if (left)
+  {
+    if (x <= 0)
+    {
+      left = false;
+    }
+    else
+    {
+      x -= SHIP_SPEED * static_cast<float>(delta_time / 1000.f);
+    }
+  }
+
+  if (right)
+  {
+    if (x >= world_width - width)
+    {
+      right = false;
+    }
+    else
+    {
+      x += SHIP_SPEED * static_cast<float>(delta_time / 1000.f);
+    }
+  }
+}
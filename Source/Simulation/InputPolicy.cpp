@@ -0,0 +1,109 @@
+#include "InputPolicy.h"
+#include "GameRules.h"
+
+/**
+ *   @brief   Constructor.
+ *   @details The seed is mixed once so that neighbouring seeds
+ *            don't start with similar choices.
+ */
+InputPolicy::InputPolicy(Kind kind_, std::uint64_t seed) :
+  kind(kind_), rng(seed)
+{
+  nextRandom(rng);
+}
+
+/**
+ *   @brief   Chooses the controls for the next frame.
+ *   @return  The SimAction flags to hold.
+ */
+std::uint8_t InputPolicy::actions(const SimState& state)
+{
+  return kind == SCRIPTED ? scriptedActions(state) : randomActions();
+}
+
+/**
+ *   @brief   Looks up a policy by name.
+ *   @return  The named kind of policy.
+ */
+InputPolicy::Kind InputPolicy::fromName(const std::string& name)
+{
+  return name == "scripted" ? SCRIPTED : RANDOM;
+}
+
+/**
+ *   @brief   Advances a SplitMix64 generator.
+ *   @details Small, fast and good enough for choosing inputs.
+ *   @return  The next random number.
+ */
+std::uint64_t InputPolicy::nextRandom(std::uint64_t& state)
+{
+  std::uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+/**
+ *   @brief   Chooses random controls
+ *   @details Controls are held for between 4 and 19 frames, much as
+ *            a player would, rather than changing every frame.
+ *   @return  The SimAction flags to hold.
+ */
+std::uint8_t InputPolicy::randomActions()
+{
+  if (hold_frames-- > 0)
+  {
+    return held;
+  }
+
+  std::uint64_t roll = nextRandom(rng);
+  const std::uint8_t moves[] = { NO_ACTION, MOVE_LEFT, MOVE_RIGHT };
+
+  held = moves[roll % 3];
+  if ((roll >> 8) % 2)
+  {
+    held |= FIRE;
+  }
+
+  hold_frames = 4 + static_cast<int>((roll >> 16) % 16);
+  return held;
+}
+
+/**
+ *   @brief   Chases the lowest alien
+ *   @details The lowest alien is the closest to reaching the ship,
+ *            so it is lined up with the muzzle and shot at.
+ *   @return  The SimAction flags to hold.
+ */
+std::uint8_t InputPolicy::scriptedActions(const SimState& state) const
+{
+  int target = -1;
+  for (int i = 0; i < state.alien_count; ++i)
+  {
+    if (state.alien_alive[i] &&
+        (target < 0 || state.alien_y[i] > state.alien_y[target]))
+    {
+      target = i;
+    }
+  }
+
+  if (target < 0)
+  {
+    return NO_ACTION;
+  }
+
+  float muzzle = state.ship_x + GameRules::MUZZLE_X;
+  float centre = state.alien_x[target] + GameRules::ALIEN_SIZE / 2;
+  float gap = centre - muzzle;
+
+  if (gap < -GameRules::ALIEN_SIZE / 4)
+  {
+    return MOVE_LEFT;
+  }
+  if (gap > GameRules::ALIEN_SIZE / 4)
+  {
+    return MOVE_RIGHT;
+  }
+
+  return FIRE;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+#include "SimState.h"
+
+/**
+ *  Chooses the controls for a headless game.
+ *  Random policies hold a random choice of controls for a random number
+ *  of frames, driven by their own seeded generator. Scripted policies
+ *  chase the lowest alien in the wave and fire once underneath it. Each
+ *  policy belongs to a single game, so none of its state is shared.
+ */
+class InputPolicy
+{
+ public:
+  enum Kind
+  {
+    RANDOM,
+    SCRIPTED
+  };
+
+  /**
+   *  Constructor.
+   *  @param [in] kind How the controls are chosen
+   *  @param [in] seed Seeds the random choices
+   */
+  InputPolicy(Kind kind, std::uint64_t seed);
+
+  /**
+   *  Chooses the controls for the next frame.
+   *  @param [in] state The game being played
+   *  @return the SimAction flags to hold
+   */
+  std::uint8_t actions(const SimState& state);
+
+  /**
+   *  Looks up a policy by name.
+   *  @param [in] name Either "random" or "scripted"
+   *  @return the named kind, or RANDOM if the name isn't known
+   */
+  static Kind fromName(const std::string& name);
+
+  /**
+   *  Advances a SplitMix64 generator.
+   *  @param [in,out] state The generator's state
+   *  @return the next random number
+   */
+  static std::uint64_t nextRandom(std::uint64_t& state);
+
+ private:
+  std::uint8_t randomActions();
+  std::uint8_t scriptedActions(const SimState& state) const;
+
+  Kind kind = RANDOM;
+  std::uint64_t rng = 0;
+  std::uint8_t held = NO_ACTION;
+  int hold_frames = 0;
+};
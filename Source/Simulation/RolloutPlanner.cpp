@@ -0,0 +1,127 @@
+#include "RolloutPlanner.h"
+#include "InputPolicy.h"
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+/**
+ *   @brief   Constructor.
+ */
+RolloutPlanner::RolloutPlanner(JobSystem& job_system,
+                               const Simulation& rules) :
+  jobs(job_system), simulation(rules)
+{
+}
+
+/**
+ *   @brief   Chooses the controls to hold
+ *   @details Every round gives each candidate the same number of
+ *            rollouts. Once the budget is spent, rollouts still
+ *            waiting to start are skipped so a round never runs far
+ *            over, except for the first, which always completes.
+ *   @return  The SimAction flags of the best candidate.
+ */
+std::uint8_t RolloutPlanner::plan(const SimState& state,
+                                  double budget_ms,
+                                  std::uint64_t seed)
+{
+  using clock = std::chrono::steady_clock;
+  auto start = clock::now();
+  auto deadline =
+    start + std::chrono::duration_cast<clock::duration>(
+              std::chrono::duration<double, std::milli>(budget_ms));
+
+  std::array<double, CANDIDATES.size()> totals{};
+  std::array<std::size_t, CANDIDATES.size()> counts{};
+  values.resize(ROLLOUTS_PER_ROUND);
+
+  std::uint64_t rng = seed;
+  bool first_round = true;
+  do
+  {
+    std::uint64_t round_seed = InputPolicy::nextRandom(rng);
+
+    auto simulate = [&](std::size_t begin, std::size_t end) {
+      for (std::size_t i = begin; i < end; ++i)
+      {
+        values[i] = std::numeric_limits<double>::quiet_NaN();
+        if (first_round || clock::now() < deadline)
+        {
+          std::uint8_t candidate = CANDIDATES[i % CANDIDATES.size()];
+          values[i] = rollout(state, candidate, round_seed + i);
+        }
+      }
+    };
+    jobs.parallelFor(0, ROLLOUTS_PER_ROUND, 1, simulate);
+
+    for (std::size_t i = 0; i < ROLLOUTS_PER_ROUND; ++i)
+    {
+      if (!std::isnan(values[i]))
+      {
+        totals[i % CANDIDATES.size()] += values[i];
+        counts[i % CANDIDATES.size()]++;
+      }
+    }
+
+    first_round = false;
+  } while (clock::now() < deadline);
+
+  std::size_t best = 0;
+  double best_value = std::numeric_limits<double>::lowest();
+  last_stats = PlannerStats();
+
+  for (std::size_t i = 0; i < CANDIDATES.size(); ++i)
+  {
+    last_stats.rollouts += counts[i];
+    double value = counts[i] > 0 ? totals[i] / double(counts[i]) : 0;
+    if (value > best_value)
+    {
+      best = i;
+      best_value = value;
+    }
+  }
+
+  std::chrono::duration<double, std::milli> elapsed = clock::now() - start;
+  last_stats.elapsed_ms = elapsed.count();
+  if (last_stats.elapsed_ms > 0)
+  {
+    last_stats.rollouts_per_ms =
+      double(last_stats.rollouts) / last_stats.elapsed_ms;
+  }
+
+  return CANDIDATES[best];
+}
+
+/**
+ *   @brief   Plays one candidate out from a clone of the game
+ *   @details The clone is a plain copy on this thread's stack, so
+ *            rollouts never touch the game or each other.
+ *   @return  The points scored, plus a bonus or penalty if the game
+ *            was won or lost within the horizon.
+ */
+double RolloutPlanner::rollout(const SimState& state,
+                               std::uint8_t candidate,
+                               std::uint64_t seed) const
+{
+  SimState clone = state;
+  InputPolicy input(InputPolicy::RANDOM, seed);
+
+  for (int frame = 0; frame < HORIZON && !Simulation::isOver(clone); ++frame)
+  {
+    std::uint8_t actions =
+      frame < HOLD_FRAMES ? candidate : input.actions(clone);
+    simulation.step(clone, actions);
+  }
+
+  double value = double(clone.score - state.score);
+  if (clone.game_won)
+  {
+    value += WIN_VALUE;
+  }
+  else if (clone.game_lose)
+  {
+    value += LOSS_VALUE;
+  }
+
+  return value;
+}
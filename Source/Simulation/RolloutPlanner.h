@@ -0,0 +1,75 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "SimState.h"
+#include "Simulation.h"
+#include "Systems/JobSystem.h"
+
+/**
+ *  How much planning the last call to plan managed.
+ */
+struct PlannerStats
+{
+  std::size_t rollouts = 0;
+  double elapsed_ms = 0;
+  double rollouts_per_ms = 0;
+};
+
+/**
+ *  Picks the controls for a game by simulating ahead.
+ *  Each candidate set of controls is held for a few frames from a clone
+ *  of the game, which then plays on with random input to the end of the
+ *  horizon. The candidate with the best average outcome is chosen.
+ *  Rollouts are spread over the worker threads in rounds until the time
+ *  budget runs out, and every rollout only touches its own clone.
+ */
+class RolloutPlanner
+{
+ public:
+  static constexpr int HOLD_FRAMES = 6; /**< Frames a choice is held. */
+  static constexpr int HORIZON = 240;   /**< Frames simulated ahead. */
+  static constexpr double WIN_VALUE = 1000;
+  static constexpr double LOSS_VALUE = -1000;
+
+  /**
+   *  Constructor.
+   *  @param [in] job_system The threads used to run rollouts
+   *  @param [in] rules The simulation shared, read-only, by every rollout
+   */
+  RolloutPlanner(JobSystem& job_system, const Simulation& rules);
+
+  /**
+   *  Chooses the controls to hold for the next HOLD_FRAMES frames.
+   *  At least one round of rollouts is run, however small the budget.
+   *  @param [in] state The game being played, which is left untouched
+   *  @param [in] budget_ms How long to spend planning
+   *  @param [in] seed Seeds the random play after each candidate
+   *  @return the SimAction flags to hold
+   */
+  std::uint8_t
+  plan(const SimState& state, double budget_ms, std::uint64_t seed);
+
+  /**
+   *  Gets how much planning the last call to plan managed.
+   *  @return the rollouts run and how long they took
+   */
+  const PlannerStats& stats() const { return last_stats; }
+
+ private:
+  static constexpr std::array<std::uint8_t, 6> CANDIDATES{
+    NO_ACTION, MOVE_LEFT, MOVE_RIGHT, FIRE, MOVE_LEFT | FIRE, MOVE_RIGHT | FIRE
+  };
+  static constexpr std::size_t ROLLOUTS_PER_ROUND = 8 * CANDIDATES.size();
+
+  double rollout(const SimState& state,
+                 std::uint8_t candidate,
+                 std::uint64_t seed) const;
+
+  JobSystem& jobs;
+  const Simulation& simulation;
+  std::vector<double> values;
+  PlannerStats last_stats;
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+/**
+ *  The controls held down for a single simulated frame.
+ */
+enum SimAction : std::uint8_t
+{
+  NO_ACTION = 0,
+  MOVE_LEFT = 1 << 0,
+  MOVE_RIGHT = 1 << 1,
+  FIRE = 1 << 2 /**< A press of the fire key, not holding it. */
+};
+
+/**
+ *  The complete state of one headless game.
+ *  Everything is stored by value in fixed-size arrays, so a game can be
+ *  saved, restored or cloned with a plain copy.
+ */
+struct SimState
+{
+  static constexpr int MAX_ALIENS = 90; /**< Ten rows of nine. */
+  static constexpr int MAX_SHOTS = 3;
+
+  std::array<float, MAX_ALIENS> alien_x;
+  std::array<float, MAX_ALIENS> alien_y;
+  std::array<bool, MAX_ALIENS> alien_alive;
+
+  std::array<float, MAX_SHOTS> laser_x;
+  std::array<float, MAX_SHOTS> laser_y;
+  std::array<bool, MAX_SHOTS> laser_live;
+
+  float ship_x;
+  float ship_y;
+
+  int alien_count;
+  int aliens_remaining;
+  int shots_remaining;
+  int score;
+  std::uint32_t frame;
+
+  bool alien_left;
+  bool fired;
+  bool game_won;
+  bool game_lose;
+};
+
+static_assert(std::is_trivially_copyable<SimState>::value,
+              "SimState must be cloneable with a plain copy");
+static_assert(sizeof(SimState) <= 1024,
+              "SimState is cloned for every rollout, so must stay small");
@@ -0,0 +1,285 @@
+#include "Simulation.h"
+#include "GameRules.h"
+#include "Utility/Rect.h"
+#include <algorithm>
+
+namespace
+{
+  rect boundsOf(float x, float y, float width, float height)
+  {
+    rect bounds;
+    bounds.x = x;
+    bounds.y = y;
+    bounds.length = width;
+    bounds.height = height;
+    return bounds;
+  }
+}
+
+/**
+ *   @brief   Constructor.
+ *   @details Sizes the wave and playfield the same way the windowed
+ *            game does. The wave is capped to fit in a SimState.
+ */
+Simulation::Simulation(const GameSettings& settings)
+{
+  int max_columns = static_cast<int>(GameRules::SCREEN_WIDTH /
+                                     GameRules::ALIEN_SIZE);
+  columns = std::min(settings.alien_columns, max_columns);
+  rows = std::min(settings.alien_rows, SimState::MAX_ALIENS / columns);
+  movement = settings.movement;
+
+  world_width = GameRules::SCREEN_WIDTH;
+  world_height =
+    std::max(float(settings.screens) * GameRules::SCREEN_HEIGHT,
+             float(rows) * GameRules::ALIEN_SIZE + 460);
+}
+
+/**
+ *   @brief   Sets up a new game
+ *   @details Aliens are laid out in rows from the top of the world,
+ *            with the ship centred near the bottom and every laser
+ *            waiting on it.
+ *   @return  void
+ */
+void Simulation::reset(SimState& state) const
+{
+  state = SimState{};
+  state.alien_count = rows * columns;
+  state.aliens_remaining = state.alien_count;
+  state.shots_remaining = GameRules::SHOTS;
+
+  for (int i = 0; i < state.alien_count; ++i)
+  {
+    state.alien_x[i] = float(i % columns) * GameRules::ALIEN_SIZE;
+    state.alien_y[i] =
+      GameRules::WAVE_TOP + float(i / columns) * GameRules::ALIEN_SIZE;
+    state.alien_alive[i] = true;
+  }
+
+  state.ship_x = world_width / 2.f - GameRules::SHIP_SIZE / 2.f;
+  state.ship_y = world_height - GameRules::SHIP_RISE;
+
+  for (int i = 0; i < SimState::MAX_SHOTS; ++i)
+  {
+    state.laser_x[i] = state.ship_x;
+    state.laser_y[i] = state.ship_y;
+  }
+}
+
+/**
+ *   @brief   Advances a game by one frame
+ *   @details The phases run in the order the windowed game's frame
+ *            graph would complete them.
+ *   @return  void
+ */
+void Simulation::step(SimState& state, std::uint8_t actions) const
+{
+  if (isOver(state))
+  {
+    return;
+  }
+
+  bool left = (actions & MOVE_LEFT) != 0;
+  bool right = (actions & MOVE_RIGHT) != 0;
+  GameRules::moveShip(state.ship_x,
+                      GameRules::SHIP_SIZE,
+                      world_width,
+                      left,
+                      right,
+                      FRAME_MS);
+
+  if (actions & FIRE)
+  {
+    state.fired = true;
+  }
+
+  moveAliens(state);
+  moveLasers(state);
+  resolveCollisions(state);
+  ++state.frame;
+}
+
+/**
+ *   @brief   Checks whether a game has finished.
+ *   @return  True once the game is won or lost.
+ */
+bool Simulation::isOver(const SimState& state)
+{
+  return state.game_won || state.game_lose;
+}
+
+/**
+ *   @brief   Moves the alien wave
+ *   @details The whole wave drops and turns around once any living
+ *            alien reaches the edge of the playfield.
+ *   @return  void
+ */
+void Simulation::moveAliens(SimState& state) const
+{
+  bool edge_reached = false;
+  for (int i = 0; i < state.alien_count && !edge_reached; ++i)
+  {
+    float x_pos = state.alien_x[i];
+    edge_reached = state.alien_alive[i] &&
+                   (state.alien_left ? x_pos <= 0 : x_pos >= world_width);
+  }
+
+  if (edge_reached)
+  {
+    state.alien_left = !state.alien_left;
+    for (int i = 0; i < state.alien_count; ++i)
+    {
+      state.alien_y[i] += GameRules::ALIEN_SIZE / 2;
+    }
+  }
+
+  GameRules::AlienStep step;
+  step.mode = movement;
+  step.direction = state.alien_left ? -1 : 1;
+  step.delta_time = FRAME_MS;
+  step.advance = !edge_reached;
+  step.world_width = world_width;
+
+  for (int i = 0; i < state.alien_count; ++i)
+  {
+    GameRules::moveAlien(step,
+                         state.alien_x[i],
+                         state.alien_y[i],
+                         GameRules::ALIEN_SIZE,
+                         GameRules::ALIEN_SIZE,
+                         0);
+  }
+}
+
+/**
+ *   @brief   Fires, reloads and moves the lasers
+ *   @details One laser is fired per frame at most. Lasers leaving
+ *            the top of the world are returned to the ship.
+ *   @return  void
+ */
+void Simulation::moveLasers(SimState& state) const
+{
+  float muzzle_x = state.ship_x + GameRules::MUZZLE_X;
+  float muzzle_y = state.ship_y + GameRules::MUZZLE_Y;
+
+  if (state.fired && state.shots_remaining > 0)
+  {
+    int shot = GameRules::SHOTS - state.shots_remaining;
+    state.laser_live[shot] = true;
+    state.laser_x[shot] = muzzle_x;
+    state.laser_y[shot] = muzzle_y;
+    state.shots_remaining--;
+    state.fired = false;
+  }
+
+  // reloads shots when all lasers shot are gone
+  if (state.shots_remaining == 0 &&
+      std::none_of(state.laser_live.begin(),
+                   state.laser_live.end(),
+                   [](bool live) { return live; }))
+  {
+    state.shots_remaining = GameRules::SHOTS;
+  }
+
+  double dt_sec = FRAME_MS / 1000.f;
+  for (int i = 0; i < SimState::MAX_SHOTS; ++i)
+  {
+    if (state.laser_live[i])
+    {
+      state.laser_y[i] += float(-GameRules::LASER_SPEED * dt_sec);
+    }
+
+    if (state.laser_y[i] < 0)
+    {
+      state.fired = false;
+      state.laser_live[i] = false;
+      state.laser_x[i] = muzzle_x;
+      state.laser_y[i] = muzzle_y;
+    }
+  }
+}
+
+/**
+ *   @brief   Resolves this frame's collisions
+ *   @details Every laser's target is found before any alien is
+ *            destroyed, exactly as the windowed game's narrowphase
+ *            does, so two lasers hitting one alien only stop the
+ *            first. The game is lost if a living alien touches the
+ *            ship and won once the wave is destroyed.
+ *   @return  void
+ */
+void Simulation::resolveCollisions(SimState& state) const
+{
+  std::array<int, SimState::MAX_SHOTS> hits;
+  for (int i = 0; i < SimState::MAX_SHOTS; ++i)
+  {
+    rect laser = boundsOf(state.laser_x[i],
+                          state.laser_y[i],
+                          GameRules::LASER_WIDTH,
+                          GameRules::LASER_HEIGHT);
+
+    hits[i] = -1;
+    for (int j = 0; j < state.alien_count && hits[i] < 0; ++j)
+    {
+      if (state.alien_alive[j] &&
+          laser.isInside(boundsOf(state.alien_x[j],
+                                  state.alien_y[j],
+                                  GameRules::ALIEN_SIZE,
+                                  GameRules::ALIEN_SIZE)))
+      {
+        hits[i] = j;
+      }
+    }
+  }
+
+  float muzzle_x = state.ship_x + GameRules::MUZZLE_X;
+  float muzzle_y = state.ship_y + GameRules::MUZZLE_Y;
+
+  for (int i = 0; i < SimState::MAX_SHOTS; ++i)
+  {
+    int hit = hits[i];
+    bool reset = false;
+
+    if (hit >= 0 && state.alien_alive[hit])
+    {
+      state.alien_alive[hit] = false;
+      state.score += GameRules::ALIEN_POINTS;
+      state.aliens_remaining--;
+      reset = true;
+    }
+    else
+    {
+      // the windowed game compares the first laser here, not this one
+      reset = state.laser_y[0] < GameRules::LASER_CEILING;
+    }
+
+    if (reset)
+    {
+      state.laser_live[i] = false;
+      state.laser_x[i] = muzzle_x;
+      state.laser_y[i] = muzzle_y;
+    }
+  }
+
+  rect ship = boundsOf(state.ship_x,
+                       state.ship_y,
+                       GameRules::SHIP_SIZE,
+                       GameRules::SHIP_SIZE);
+  for (int i = 0; i < state.alien_count; ++i)
+  {
+    if (state.alien_alive[i] &&
+        ship.isInside(boundsOf(state.alien_x[i],
+                               state.alien_y[i],
+                               GameRules::ALIEN_SIZE,
+                               GameRules::ALIEN_SIZE)))
+    {
+      state.game_lose = true;
+    }
+  }
+
+  if (state.aliens_remaining == 0)
+  {
+    state.game_won = true;
+  }
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+
+#include "GameSettings.h"
+#include "SimState.h"
+
+/**
+ *  Plays the game without a window, renderer or engine.
+ *  Runs the same rules as the windowed game on a SimState at a fixed
+ *  frame rate. The simulation itself is never changed once constructed,
+ *  so any number of threads may step their own games with it at once.
+ */
+class Simulation
+{
+ public:
+  static constexpr double FRAME_MS = 1000.0 / 60.0;
+
+  /**
+   *  Constructor.
+   *  @param [in] settings The size of the wave and the movement mode
+   */
+  explicit Simulation(const GameSettings& settings);
+
+  /**
+   *  Sets up a new game.
+   *  @param [out] state Overwritten with the start of a game
+   */
+  void reset(SimState& state) const;
+
+  /**
+   *  Advances a game by one frame.
+   *  Finished games are left as they are.
+   *  @param [in,out] state The game to advance
+   *  @param [in] actions The SimAction flags held this frame
+   */
+  void step(SimState& state, std::uint8_t actions) const;
+
+  /**
+   *  Checks whether a game has finished.
+   *  @param [in] state The game to check
+   *  @return true once the game is won or lost
+   */
+  static bool isOver(const SimState& state);
+
+  float worldWidth() const { return world_width; }
+  float worldHeight() const { return world_height; }
+
+ private:
+  void moveAliens(SimState& state) const;
+  void moveLasers(SimState& state) const;
+  void resolveCollisions(SimState& state) const;
+
+  int rows = 1;
+  int columns = 7;
+  int movement = 1;
+  float world_width = 0;
+  float world_height = 0;
+};
@@ -0,0 +1,90 @@
+#include "SpaceInvadersEnv.h"
+#include "VectorEnv.h"
+#include <exception>
+#include <memory>
+
+/**
+ *  The threads and games behind a handle.
+ */
+struct SpaceInvadersEnv
+{
+  SpaceInvadersEnv(const GameSettings& settings, std::size_t envs) :
+    jobs(settings.workerThreads()), games(jobs, settings, envs)
+  {
+  }
+
+  JobSystem jobs;
+  VectorEnv games;
+};
+
+/**
+ *   @brief   Creates a set of games
+ *   @details Nothing may be thrown across the C interface, so any
+ *            failure is reported as a null handle.
+ *   @return  The games, or null on failure.
+ */
+SpaceInvadersEnv* si_env_create(size_t envs,
+                                int rows,
+                                int columns,
+                                int movement,
+                                int max_frames,
+                                int threads)
+{
+  GameSettings settings;
+  settings.alien_rows = rows > 0 ? rows : 1;
+  settings.alien_columns = columns > 0 ? columns : 1;
+  settings.movement = movement >= 1 && movement <= 4 ? movement : 1;
+  settings.max_frames = max_frames > 0 ? max_frames : settings.max_frames;
+  settings.worker_threads = threads;
+
+  try
+  {
+    return std::make_unique<SpaceInvadersEnv>(settings, envs).release();
+  }
+  catch (const std::exception&)
+  {
+    return nullptr;
+  }
+}
+
+/**
+ *   @brief   Destroys a set of games.
+ *   @return  void
+ */
+void si_env_destroy(SpaceInvadersEnv* env)
+{
+  delete env;
+}
+
+/**
+ *   @brief   Gets the number of floats in one observation.
+ *   @return  The observation size.
+ */
+int si_env_observation_size(void)
+{
+  return VectorEnv::OBSERVATION_SIZE;
+}
+
+/**
+ *   @brief   Starts a new episode in every game.
+ *   @return  void
+ */
+void si_env_reset(SpaceInvadersEnv* env,
+                  const uint64_t* seeds,
+                  float* observations)
+{
+  env->games.reset(seeds, observations);
+}
+
+/**
+ *   @brief   Advances every game by one frame.
+ *   @return  void
+ */
+void si_env_step(SpaceInvadersEnv* env,
+                 const uint8_t* actions,
+                 float* observations,
+                 float* rewards,
+                 uint8_t* dones)
+{
+  env->games.step(actions, observations, rewards, dones);
+}
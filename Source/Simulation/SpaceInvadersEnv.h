@@ -0,0 +1,83 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ *  A C interface to VectorEnv, for loading the headless game from
+ *  training frameworks in other languages.
+ *  Buffers are owned by the caller and written in place; see VectorEnv
+ *  for their layout. A handle may only be used by one thread at a time.
+ *  The SpaceInvadersEnvShared target builds it as a shared library that
+ *  exports only these functions.
+ */
+#if defined(_WIN32) && defined(SI_ENV_SHARED)
+#  define SI_ENV_API __declspec(dllexport)
+#elif defined(__GNUC__)
+#  define SI_ENV_API __attribute__((visibility("default")))
+#else
+#  define SI_ENV_API
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  typedef struct SpaceInvadersEnv SpaceInvadersEnv;
+
+  /**
+   *  Creates a set of games.
+   *  @param [in] envs The number of games stepped together
+   *  @param [in] rows Rows of aliens in each wave
+   *  @param [in] columns Aliens in each row
+   *  @param [in] movement Alien movement mode, from 1 to 4
+   *  @param [in] max_frames Episodes are truncated after this many frames
+   *  @param [in] threads Worker threads, -1 for one per spare core
+   *  @return the games, or null if they couldn't be created
+   */
+  SI_ENV_API SpaceInvadersEnv* si_env_create(size_t envs,
+                                             int rows,
+                                             int columns,
+                                             int movement,
+                                             int max_frames,
+                                             int threads);
+
+  /**
+   *  Destroys a set of games and stops its threads.
+   *  @param [in] env The games, may be null
+   */
+  SI_ENV_API void si_env_destroy(SpaceInvadersEnv* env);
+
+  /**
+   *  Gets the number of floats in one game's observation.
+   *  @return the observation size
+   */
+  SI_ENV_API int si_env_observation_size(void);
+
+  /**
+   *  Starts a new episode in every game.
+   *  @param [in] env The games
+   *  @param [in] seeds One seed per game
+   *  @param [out] observations One observation per game
+   */
+  SI_ENV_API void si_env_reset(SpaceInvadersEnv* env,
+                               const uint64_t* seeds,
+                               float* observations);
+
+  /**
+   *  Advances every game by one frame.
+   *  @param [in] env The games
+   *  @param [in] actions One set of action flags per game
+   *  @param [out] observations One observation per game
+   *  @param [out] rewards One reward per game
+   *  @param [out] dones One done flag per game
+   */
+  SI_ENV_API void si_env_step(SpaceInvadersEnv* env,
+                              const uint8_t* actions,
+                              float* observations,
+                              float* rewards,
+                              uint8_t* dones);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,146 @@
+#include "VectorEnv.h"
+#include "InputPolicy.h"
+
+/**
+ *   @brief   Constructor.
+ *   @details Every game starts from the first frame of seed zero
+ *            until reset is called.
+ */
+VectorEnv::VectorEnv(JobSystem& job_system,
+                     const GameSettings& settings,
+                     std::size_t envs) :
+  jobs(job_system),
+  simulation(settings),
+  max_frames(static_cast<std::uint32_t>(settings.max_frames)),
+  states(envs),
+  episode_seeds(envs, 0)
+{
+  for (SimState& state : states)
+  {
+    simulation.reset(state);
+  }
+}
+
+/**
+ *   @brief   Starts a new episode in every game
+ *   @details Games are reset and observed on the worker threads.
+ *   @return  void
+ */
+void VectorEnv::reset(const std::uint64_t* seeds, float* observations)
+{
+  auto start = [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      resetGame(i, seeds[i]);
+      observe(i, observations + i * OBSERVATION_SIZE);
+    }
+  };
+  jobs.parallelFor(0, size(), ENV_GRAIN, start);
+}
+
+/**
+ *   @brief   Advances every game by one frame
+ *   @details Games are stepped in contiguous blocks, so each thread
+ *            writes neighbouring slices of the caller's buffers and
+ *            never shares a cache line with another except at the
+ *            edges of its block.
+ *   @return  void
+ */
+void VectorEnv::step(const std::uint8_t* actions,
+                     float* observations,
+                     float* rewards,
+                     std::uint8_t* dones)
+{
+  auto advance = [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      SimState& state = states[i];
+      int score = state.score;
+      simulation.step(state, actions[i]);
+
+      Done done = RUNNING;
+      if (Simulation::isOver(state))
+      {
+        done = TERMINATED;
+      }
+      else if (state.frame >= max_frames)
+      {
+        done = TRUNCATED;
+      }
+
+      rewards[i] = float(state.score - score);
+      dones[i] = done;
+
+      if (done != RUNNING)
+      {
+        resetGame(i, episode_seeds[i] + size());
+      }
+      observe(i, observations + i * OBSERVATION_SIZE);
+    }
+  };
+  jobs.parallelFor(0, size(), ENV_GRAIN, advance);
+}
+
+/**
+ *   @brief   Starts a new episode in one game
+ *   @details Idle frames are played before the episode starts so
+ *            agents don't always see the same opening.
+ *   @return  void
+ */
+void VectorEnv::resetGame(std::size_t env, std::uint64_t seed)
+{
+  SimState& state = states[env];
+  simulation.reset(state);
+  episode_seeds[env] = seed;
+
+  std::uint64_t rng = seed;
+  auto idle = InputPolicy::nextRandom(rng) % (NOOP_MAX + 1);
+  for (std::uint64_t i = 0; i < idle; ++i)
+  {
+    simulation.step(state, NO_ACTION);
+  }
+  state.frame = 0;
+}
+
+/**
+ *   @brief   Writes a game's observation
+ *   @details Each field is written as its own run of floats, so the
+ *            loops over every alien slot can be vectorised. Empty
+ *            slots are reported as dead aliens at the origin.
+ *   @return  void
+ */
+void VectorEnv::observe(std::size_t env, float* observation) const
+{
+  const SimState& state = states[env];
+  float scale_x = 1.f / simulation.worldWidth();
+  float scale_y = 1.f / simulation.worldHeight();
+
+  float* out = observation;
+  *out++ = state.ship_x * scale_x;
+  *out++ = state.ship_y * scale_y;
+
+  for (int i = 0; i < SimState::MAX_SHOTS; ++i)
+  {
+    out[i] = state.laser_x[i] * scale_x;
+    out[i + SimState::MAX_SHOTS] = state.laser_y[i] * scale_y;
+    out[i + 2 * SimState::MAX_SHOTS] = state.laser_live[i] ? 1.f : 0.f;
+  }
+  out += 3 * SimState::MAX_SHOTS;
+
+  for (int i = 0; i < SimState::MAX_ALIENS; ++i)
+  {
+    out[i] = state.alien_x[i] * scale_x;
+  }
+  out += SimState::MAX_ALIENS;
+
+  for (int i = 0; i < SimState::MAX_ALIENS; ++i)
+  {
+    out[i] = state.alien_y[i] * scale_y;
+  }
+  out += SimState::MAX_ALIENS;
+
+  for (int i = 0; i < SimState::MAX_ALIENS; ++i)
+  {
+    out[i] = state.alien_alive[i] ? 1.f : 0.f;
+  }
+}
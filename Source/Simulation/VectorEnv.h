@@ -0,0 +1,86 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "GameSettings.h"
+#include "SimState.h"
+#include "Simulation.h"
+#include "Systems/JobSystem.h"
+
+/**
+ *  Steps many headless games at once for training agents.
+ *  Every call advances every game by one frame, writing straight into
+ *  buffers owned by the caller, so nothing is allocated or copied per
+ *  step. Games are shared out between the worker threads in blocks, and
+ *  each game only ever writes its own slice of the buffers.
+ *
+ *  An observation is OBSERVATION_SIZE floats, planar and scaled to the
+ *  playfield: the ship's x and y, then the x, y and live flag of every
+ *  laser, then the x, y and alive flag of every alien slot.
+ */
+class VectorEnv
+{
+ public:
+  static constexpr int OBSERVATION_SIZE =
+    2 + 3 * SimState::MAX_SHOTS + 3 * SimState::MAX_ALIENS;
+  static constexpr int NOOP_MAX = 30; /**< Most idle frames on reset. */
+
+  /**
+   *  Why a game's episode ended on a step.
+   */
+  enum Done : std::uint8_t
+  {
+    RUNNING = 0,
+    TERMINATED = 1, /**< The game was won or lost. */
+    TRUNCATED = 2   /**< The game ran out of frames. */
+  };
+
+  /**
+   *  Constructor.
+   *  @param [in] job_system The threads used to step the games
+   *  @param [in] settings The wave, movement mode and frame limit
+   *  @param [in] envs The number of games
+   */
+  VectorEnv(JobSystem& job_system,
+            const GameSettings& settings,
+            std::size_t envs);
+
+  /**
+   *  Starts a new episode in every game.
+   *  The rules are deterministic, so each game's seed picks how many
+   *  idle frames, up to NOOP_MAX, are played before its first step.
+   *  @param [in] seeds One seed per game
+   *  @param [out] observations size() * OBSERVATION_SIZE floats
+   */
+  void reset(const std::uint64_t* seeds, float* observations);
+
+  /**
+   *  Advances every game by one frame.
+   *  A game whose episode ends is reset straight away with its seed
+   *  plus size(), and its observation is the start of the new episode.
+   *  @param [in] actions One set of SimAction flags per game
+   *  @param [out] observations size() * OBSERVATION_SIZE floats
+   *  @param [out] rewards One per game, the points scored this step
+   *  @param [out] dones One Done per game
+   */
+  void step(const std::uint8_t* actions,
+            float* observations,
+            float* rewards,
+            std::uint8_t* dones);
+
+  std::size_t size() const { return states.size(); }
+  const SimState& state(std::size_t env) const { return states[env]; }
+
+ private:
+  static constexpr std::size_t ENV_GRAIN = 32;
+
+  void resetGame(std::size_t env, std::uint64_t seed);
+  void observe(std::size_t env, float* observation) const;
+
+  JobSystem& jobs;
+  Simulation simulation;
+  std::uint32_t max_frames = 0;
+  std::vector<SimState> states;
+  std::vector<std::uint64_t> episode_seeds;
+};
@@ -0,0 +1,174 @@
+#include "BatchRunner.h"
+#include "GameSettings.h"
+#include "RolloutPlanner.h"
+#include "Simulation.h"
+#include "Systems/JobSystem.h"
+#include "Systems/SamplingProfiler.h"
+#include "VectorEnv.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+  void playBatch(JobSystem& jobs, const GameSettings& settings)
+  {
+    Simulation simulation(settings);
+    BatchRunner runner(jobs, simulation);
+
+    BatchReport report =
+      runner.run(settings.games,
+                 settings.seed,
+                 InputPolicy::fromName(settings.policy),
+                 static_cast<std::uint32_t>(settings.max_frames));
+
+    std::cout << "Played " << report.games << " games on " << report.threads
+              << " threads in " << report.seconds << "s ("
+              << report.games_per_second << " games/s)" << std::endl;
+    std::cout << "Won " << report.wins << ", lost " << report.losses
+              << ", abandoned " << report.abandoned << ", mean score "
+              << report.mean_score << ", mean frames " << report.mean_frames
+              << std::endl;
+
+    if (!settings.outcomes.empty())
+    {
+      std::ofstream file(settings.outcomes);
+      file << "seed,score,frames,result\n";
+      for (const GameOutcome& outcome : runner.outcomes())
+      {
+        const char* result =
+          outcome.won ? "won" : outcome.lost ? "lost" : "abandoned";
+        file << outcome.seed << ',' << outcome.score << ','
+             << outcome.frames << ',' << result << '\n';
+      }
+    }
+  }
+
+  void stepEnvs(JobSystem& jobs, const GameSettings& settings)
+  {
+    VectorEnv env(jobs, settings, settings.envs);
+    std::vector<std::uint64_t> seeds(env.size());
+    std::vector<std::uint8_t> actions(env.size());
+    std::vector<float> observations(env.size() *
+                                    VectorEnv::OBSERVATION_SIZE);
+    std::vector<float> rewards(env.size());
+    std::vector<std::uint8_t> dones(env.size());
+
+    for (std::size_t i = 0; i < env.size(); ++i)
+    {
+      seeds[i] = settings.seed + i;
+    }
+    env.reset(seeds.data(), observations.data());
+
+    std::uint64_t rng = settings.seed;
+    std::size_t episodes = 0;
+    double total_reward = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (std::size_t step = 0; step < settings.env_steps; ++step)
+    {
+      for (std::uint8_t& action : actions)
+      {
+        action = static_cast<std::uint8_t>(InputPolicy::nextRandom(rng) &
+                                            (MOVE_LEFT | MOVE_RIGHT | FIRE));
+      }
+
+      env.step(actions.data(),
+               observations.data(),
+               rewards.data(),
+               dones.data());
+
+      for (std::size_t i = 0; i < env.size(); ++i)
+      {
+        episodes += dones[i] != VectorEnv::RUNNING ? 1 : 0;
+        total_reward += rewards[i];
+      }
+    }
+
+    std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+    double steps = double(env.size()) * double(settings.env_steps);
+
+    std::cout << "Stepped " << env.size() << " games " << settings.env_steps
+              << " times on " << jobs.concurrency() << " threads in "
+              << elapsed.count() << "s (" << steps / elapsed.count()
+              << " steps/s)" << std::endl;
+    std::cout << "Finished " << episodes << " episodes, total reward "
+              << total_reward << std::endl;
+  }
+
+  void pilotGames(JobSystem& jobs, const GameSettings& settings)
+  {
+    Simulation simulation(settings);
+    RolloutPlanner planner(jobs, simulation);
+    std::uint64_t rng = settings.seed;
+
+    std::size_t wins = 0;
+    std::size_t losses = 0;
+    double total_score = 0;
+    double rollouts = 0;
+    double planning_ms = 0;
+
+    for (std::size_t game = 0; game < settings.games; ++game)
+    {
+      SimState state;
+      simulation.reset(state);
+
+      while (state.frame < std::uint32_t(settings.max_frames) &&
+             !Simulation::isOver(state))
+      {
+        std::uint8_t actions = planner.plan(
+          state, settings.plan_budget_ms, InputPolicy::nextRandom(rng));
+        rollouts += double(planner.stats().rollouts);
+        planning_ms += planner.stats().elapsed_ms;
+
+        for (int i = 0; i < RolloutPlanner::HOLD_FRAMES; ++i)
+        {
+          simulation.step(state, actions);
+        }
+      }
+
+      wins += state.game_won ? 1 : 0;
+      losses += state.game_lose ? 1 : 0;
+      total_score += state.score;
+    }
+
+    std::cout << "Piloted " << settings.games << " games on "
+              << jobs.concurrency() << " threads, won " << wins << ", lost "
+              << losses << ", mean score "
+              << total_score / double(std::max<std::size_t>(1, settings.games))
+              << std::endl;
+    std::cout << "Planned with " << rollouts << " rollouts at "
+              << (planning_ms > 0 ? rollouts / planning_ms : 0)
+              << " rollouts/ms" << std::endl;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  GameSettings settings = GameSettings::fromArgs(argc, argv);
+  if (!settings.sample_file.empty())
+  {
+    SamplingProfiler::start(settings.sample_hz);
+  }
+
+  JobSystem jobs(settings.workerThreads());
+
+  if (settings.envs > 0)
+  {
+    stepEnvs(jobs, settings);
+  }
+  else if (settings.policy == "planner")
+  {
+    pilotGames(jobs, settings);
+  }
+  else
+  {
+    playBatch(jobs, settings);
+  }
+
+  SamplingProfiler::stop(settings.sample_file);
+  return 0;
+}
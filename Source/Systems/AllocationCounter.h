@@ -0,0 +1,18 @@
+#pragma once
+#include <cstdint>
+
+/**
+ *  Counts heap allocations made anywhere in the program.
+ *  Linking AllocationCounter.cpp replaces the global operator new with
+ *  one that bumps a counter before allocating. The counter is a single
+ *  relaxed atomic, so counting adds next to nothing to an allocation.
+ */
+class AllocationCounter
+{
+ public:
+  /**
+   *  Gets the number of allocations made so far.
+   *  @return the allocations made by every thread since launch
+   */
+  static std::uint64_t count();
+};
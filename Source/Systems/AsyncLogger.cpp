@@ -0,0 +1,325 @@
+#include "AsyncLogger.h"
+#include "ThreadRegistry.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  constexpr auto DRAIN_INTERVAL = std::chrono::milliseconds(50);
+
+  /**
+   *  One thread's records. Only the owning thread moves the head and
+   *  only the background thread moves the tail.
+   */
+  struct LogRing
+  {
+    std::array<LogRecord, AsyncLogger::RING_SIZE> records;
+    alignas(64) std::atomic<std::size_t> head{ 0 };
+    alignas(64) std::atomic<std::size_t> tail{ 0 };
+    std::atomic<std::uint64_t> dropped{ 0 };
+  };
+
+  /**
+   *  Records from threads that found every ring in use, shared by all
+   *  of them. Each cell's sequence says whether it is free to claim,
+   *  waiting to be written out, or still being filled in.
+   */
+  struct SharedRing
+  {
+    struct Cell
+    {
+      std::atomic<std::size_t> sequence{ 0 };
+      LogRecord record;
+    };
+
+    SharedRing()
+    {
+      for (std::size_t i = 0; i < cells.size(); ++i)
+      {
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+      }
+    }
+
+    std::array<Cell, AsyncLogger::RING_SIZE> cells;
+    alignas(64) std::atomic<std::size_t> head{ 0 };
+    alignas(64) std::size_t tail = 0;
+    std::atomic<std::uint64_t> dropped{ 0 };
+  };
+
+  /**
+   *  What the calling thread claimed last, for commit to publish.
+   */
+  struct Claim
+  {
+    LogRing* ring = nullptr;
+    SharedRing::Cell* cell = nullptr;
+    std::size_t position = 0;
+  };
+
+  ThreadRegistry<LogRing, AsyncLogger::MAX_THREADS> rings;
+  SharedRing shared;
+  thread_local Claim last_claim;
+
+  std::mutex state_mutex;
+  std::condition_variable wake;
+  bool stopping = false;
+  std::thread writer;
+  std::FILE* file = nullptr;
+  AsyncLogger::clock::time_point started;
+
+  void writeArg(std::string& line, LogArg::Type type, const LogArg& arg)
+  {
+    char text[32];
+    switch (type)
+    {
+      case LogArg::SIGNED:
+        std::snprintf(
+          text, sizeof(text), "%lld", static_cast<long long>(arg.i));
+        break;
+      case LogArg::UNSIGNED:
+        std::snprintf(
+          text, sizeof(text), "%llu", static_cast<unsigned long long>(arg.u));
+        break;
+      case LogArg::FLOATING:
+        std::snprintf(text, sizeof(text), "%g", arg.d);
+        break;
+      case LogArg::BOOLEAN:
+        std::snprintf(text, sizeof(text), "%s", arg.u ? "true" : "false");
+        break;
+      case LogArg::TEXT:
+        line += arg.s != nullptr ? arg.s : "(null)";
+        return;
+    }
+    line += text;
+  }
+
+  /**
+   *  Formats a record as a line of the log.
+   *  Placeholders beyond the last argument are left as they are.
+   */
+  void format(std::string& line, const LogRecord& record, int thread)
+  {
+    std::chrono::duration<double> since =
+      AsyncLogger::clock::duration(record.time_ns) -
+      started.time_since_epoch();
+
+    char prefix[48];
+    std::snprintf(
+      prefix, sizeof(prefix), "[%.6fs] T%d ", since.count(), thread);
+    line = prefix;
+
+    std::size_t next = 0;
+    for (const char* c = record.format; *c != '\0'; ++c)
+    {
+      if (c[0] == '{' && c[1] == '}' && next < record.count)
+      {
+        writeArg(line, record.types[next], record.args[next]);
+        ++next;
+        ++c;
+      }
+      else
+      {
+        line += *c;
+      }
+    }
+    line += '\n';
+  }
+
+  void writeDropped(int thread, std::atomic<std::uint64_t>& dropped)
+  {
+    std::uint64_t count = dropped.exchange(0);
+    if (count > 0)
+    {
+      std::fprintf(file,
+                   "T%d dropped %llu records\n",
+                   thread,
+                   static_cast<unsigned long long>(count));
+    }
+  }
+
+  /**
+   *  Writes out every record in every ring.
+   *  Rings whose threads have exited are handed back once emptied.
+   *  Only called by the background thread, or once it has stopped.
+   */
+  void drain()
+  {
+    std::string line;
+    rings.forEach([&line](LogRing& ring, bool retired) {
+      int id = rings.id(ring);
+      std::size_t tail = ring.tail.load(std::memory_order_relaxed);
+      std::size_t head = ring.head.load(std::memory_order_acquire);
+      for (; tail != head; ++tail)
+      {
+        format(line, ring.records[tail % AsyncLogger::RING_SIZE], id);
+        std::fwrite(line.data(), 1, line.size(), file);
+      }
+      ring.tail.store(tail, std::memory_order_release);
+      writeDropped(id, ring.dropped);
+
+      if (retired)
+      {
+        rings.recycle(ring);
+      }
+    });
+
+    // stops at the first cell still being filled in, to keep order
+    for (;;)
+    {
+      SharedRing::Cell& cell =
+        shared.cells[shared.tail % AsyncLogger::RING_SIZE];
+      if (cell.sequence.load(std::memory_order_acquire) != shared.tail + 1)
+      {
+        break;
+      }
+
+      format(line, cell.record, 0);
+      std::fwrite(line.data(), 1, line.size(), file);
+      cell.sequence.store(shared.tail + AsyncLogger::RING_SIZE,
+                          std::memory_order_release);
+      ++shared.tail;
+    }
+    writeDropped(0, shared.dropped);
+
+    std::fflush(file);
+  }
+
+  void writerLoop()
+  {
+    std::unique_lock<std::mutex> lock(state_mutex);
+    while (!stopping)
+    {
+      wake.wait_for(lock, DRAIN_INTERVAL);
+      drain();
+    }
+  }
+}
+
+/**
+ *   @brief   Starts writing log records to a file
+ *   @details Records logged before the logger starts are lost, as
+ *            they're never stored.
+ *   @return  True if logging started.
+ */
+bool AsyncLogger::start(const std::string& path)
+{
+  std::lock_guard<std::mutex> lock(state_mutex);
+  if (file != nullptr)
+  {
+    return false;
+  }
+
+  file = std::fopen(path.c_str(), "a");
+  if (file == nullptr)
+  {
+    return false;
+  }
+
+  started = clock::now();
+  stopping = false;
+  writer = std::thread(writerLoop);
+  active = true;
+  return true;
+}
+
+/**
+ *   @brief   Writes out every record and stops logging
+ *   @details Anything logged while this runs may miss the last drain
+ *            and be lost.
+ *   @return  void
+ */
+void AsyncLogger::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(state_mutex);
+    if (file == nullptr)
+    {
+      return;
+    }
+
+    active = false;
+    stopping = true;
+  }
+
+  wake.notify_one();
+  writer.join();
+
+  drain();
+  std::fclose(file);
+  file = nullptr;
+}
+
+/**
+ *   @brief   Gets the next free record in the calling thread's ring
+ *   @details Threads that couldn't get a ring of their own claim a
+ *            record in the shared ring instead. The record isn't
+ *            visible to the background thread until it is committed.
+ *   @return  The record, or nullptr if the ring is full.
+ */
+LogRecord* AsyncLogger::claim()
+{
+  LogRing* ring = rings.local();
+  last_claim.ring = ring;
+  if (ring != nullptr)
+  {
+    std::size_t head = ring->head.load(std::memory_order_relaxed);
+    if (head - ring->tail.load(std::memory_order_acquire) >= RING_SIZE)
+    {
+      ring->dropped.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+
+    return &ring->records[head % RING_SIZE];
+  }
+
+  std::size_t position = shared.head.load(std::memory_order_relaxed);
+  for (;;)
+  {
+    SharedRing::Cell& cell = shared.cells[position % RING_SIZE];
+    std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+    if (sequence == position)
+    {
+      if (shared.head.compare_exchange_weak(
+            position, position + 1, std::memory_order_relaxed))
+      {
+        last_claim.cell = &cell;
+        last_claim.position = position;
+        return &cell.record;
+      }
+    }
+    else if (sequence < position)
+    {
+      // a lap behind, so the writer hasn't emptied it yet
+      shared.dropped.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    else
+    {
+      position = shared.head.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+/**
+ *   @brief   Commits the record from the last claim.
+ *   @return  void
+ */
+void AsyncLogger::commit()
+{
+  if (last_claim.ring != nullptr)
+  {
+    LogRing* ring = last_claim.ring;
+    ring->head.store(ring->head.load(std::memory_order_relaxed) + 1,
+                     std::memory_order_release);
+    return;
+  }
+
+  last_claim.cell->sequence.store(last_claim.position + 1,
+                                  std::memory_order_release);
+}
@@ -0,0 +1,164 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+/**
+ *  One argument of a log record, stored raw until it is formatted.
+ */
+struct LogArg
+{
+  enum Type : std::uint8_t
+  {
+    SIGNED,
+    UNSIGNED,
+    FLOATING,
+    BOOLEAN,
+    TEXT
+  };
+
+  union
+  {
+    std::int64_t i;
+    std::uint64_t u;
+    double d;
+    const char* s;
+  };
+};
+
+/**
+ *  A log call as it sits in a thread's ring: the format string, when
+ *  the call was made and its arguments, unformatted.
+ */
+struct LogRecord
+{
+  static constexpr std::size_t MAX_ARGS = 6;
+
+  const char* format;
+  std::int64_t time_ns;
+  std::uint8_t count;
+  std::array<LogArg::Type, MAX_ARGS> types;
+  std::array<LogArg, MAX_ARGS> args;
+};
+
+/**
+ *  Logs from any thread without blocking it.
+ *  A log call copies a pointer to its format string and its arguments,
+ *  unformatted, into a ring owned by the calling thread, so it never
+ *  takes a lock, allocates or touches a stream. A background thread
+ *  drains every ring a few times a second, replaces each {} in the
+ *  format with the next argument and appends the line to the log file.
+ *  A full ring drops the record and counts it, rather than wait.
+ *
+ *  A thread's ring is handed to another once the thread has exited and
+ *  its records are written out, so short lived threads, such as the
+ *  engine's input callbacks, share a few rings. Threads that find
+ *  every ring in use log to one ring shared between them, marked T0.
+ *
+ *  Format strings and any string arguments are only read when the
+ *  record is written out, so they must be string literals or otherwise
+ *  live for the rest of the program.
+ */
+class AsyncLogger
+{
+ public:
+  using clock = std::chrono::steady_clock;
+
+  static constexpr std::size_t RING_SIZE = 1024; /**< Records per thread. */
+  static constexpr int MAX_THREADS = 32; /**< Rings of their own. */
+
+  /**
+   *  Starts writing log records to a file.
+   *  @param [in] path The file to append to
+   *  @return false if the file couldn't be opened or logging is on
+   */
+  static bool start(const std::string& path);
+
+  /**
+   *  Writes out every record logged so far and stops logging.
+   */
+  static void stop();
+
+  /**
+   *  Logs a message.
+   *  Does nothing unless the logger has been started.
+   *  @param [in] format The message, with {} where each argument goes
+   *  @param [in] args Numbers, bools or long lived strings
+   */
+  template <typename... Args>
+  static void log(const char* format, Args... args)
+  {
+    static_assert(sizeof...(Args) <= LogRecord::MAX_ARGS,
+                  "too many arguments for one log record");
+
+    if (!active.load(std::memory_order_relaxed))
+    {
+      return;
+    }
+
+    LogRecord* record = claim();
+    if (record == nullptr)
+    {
+      return;
+    }
+
+    record->format = format;
+    record->time_ns = clock::now().time_since_epoch().count();
+    record->count = sizeof...(Args);
+
+    std::size_t i = 0;
+    (store(*record, i++, args), ...);
+    commit();
+  }
+
+ private:
+  template <typename T>
+  static void store(LogRecord& record, std::size_t i, T value)
+  {
+    LogArg& arg = record.args[i];
+    if constexpr (std::is_same_v<T, bool>)
+    {
+      record.types[i] = LogArg::BOOLEAN;
+      arg.u = value ? 1 : 0;
+    }
+    else if constexpr (std::is_floating_point_v<T>)
+    {
+      record.types[i] = LogArg::FLOATING;
+      arg.d = static_cast<double>(value);
+    }
+    else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+    {
+      record.types[i] = LogArg::SIGNED;
+      arg.i = static_cast<std::int64_t>(value);
+    }
+    else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>)
+    {
+      record.types[i] = LogArg::UNSIGNED;
+      arg.u = static_cast<std::uint64_t>(value);
+    }
+    else
+    {
+      static_assert(std::is_convertible_v<T, const char*>,
+                    "only numbers, bools and strings can be logged");
+      record.types[i] = LogArg::TEXT;
+      arg.s = value;
+    }
+  }
+
+  /**
+   *  Gets the next free record in the calling thread's ring.
+   *  @return the record, or nullptr if the ring is full
+   */
+  static LogRecord* claim();
+
+  /**
+   *  Hands the record from the last claim to the background thread.
+   */
+  static void commit();
+
+  static inline std::atomic<bool> active{ false };
+};
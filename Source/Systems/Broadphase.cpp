@@ -0,0 +1,96 @@
+#include "Broadphase.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ *   @brief   Constructor.
+ *   @details Cells should be larger than the entities, so that each
+ *            query only needs to look at a few of them.
+ *   @return  void
+ */
+Broadphase::Broadphase(float cell_size_, float max_entity_size) :
+  cell_size(cell_size_), max_size(max_entity_size)
+{
+}
+
+/**
+ *   @brief   Sizes the grid to cover an area.
+ *   @details Vectors keep their capacity, so rebuilding the grid
+ *            each frame doesn't allocate once it has warmed up.
+ *   @return  void
+ */
+void Broadphase::resize(const rect& area, std::size_t count)
+{
+  grid_area = area;
+  columns = std::max(1, static_cast<int>(std::ceil(area.length / cell_size)));
+  rows = std::max(1, static_cast<int>(std::ceil(area.height / cell_size)));
+
+  cell_of.resize(count);
+  cell_start.resize(static_cast<std::size_t>(columns * rows) + 1);
+}
+
+/**
+ *   @brief   Buckets the entities by cell.
+ *   @details A counting sort: count each cell, turn the counts into
+ *            offsets, then scatter the entity indices into place.
+ *            Entities keep their relative order within a cell.
+ *   @return  void
+ */
+void Broadphase::sortIntoCells()
+{
+  std::fill(cell_start.begin(), cell_start.end(), 0);
+
+  for (auto cell : cell_of)
+  {
+    if (cell != NONE)
+    {
+      ++cell_start[cell + 1];
+    }
+  }
+
+  for (std::size_t i = 1; i < cell_start.size(); ++i)
+  {
+    cell_start[i] += cell_start[i - 1];
+  }
+
+  entities.resize(cell_start.back());
+
+  // a scratch copy of the offsets acts as each cell's write cursor
+  cursors.assign(cell_start.begin(), cell_start.end() - 1);
+  for (std::size_t i = 0; i < cell_of.size(); ++i)
+  {
+    if (cell_of[i] != NONE)
+    {
+      entities[cursors[cell_of[i]]++] = static_cast<std::uint32_t>(i);
+    }
+  }
+}
+
+/**
+ *   @brief   Finds the grid column containing an x coordinate.
+ *   @return  The column, clamped to the grid.
+ */
+int Broadphase::columnAt(float x) const
+{
+  int column = static_cast<int>(std::floor((x - grid_area.x) / cell_size));
+  return std::max(0, std::min(column, columns - 1));
+}
+
+/**
+ *   @brief   Finds the grid row containing a y coordinate.
+ *   @return  The row, clamped to the grid.
+ */
+int Broadphase::rowAt(float y) const
+{
+  int row = static_cast<int>(std::floor((y - grid_area.y) / cell_size));
+  return std::max(0, std::min(row, rows - 1));
+}
+
+/**
+ *   @brief   Finds the cell containing a point.
+ *   @return  The cell's index in the grid.
+ */
+std::uint32_t Broadphase::cellAt(float x, float y) const
+{
+  return static_cast<std::uint32_t>(rowAt(y) * columns + columnAt(x));
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "JobSystem.h"
+#include "Utility/Rect.h"
+
+/**
+ *  A uniform grid used to find potential collisions.
+ *  Entities are bucketed by the cell containing their top left corner,
+ *  so a query only has to look at the cells its area covers, widened
+ *  by the size of the largest entity. Cell keys are computed in parallel
+ *  and the buckets are then laid out contiguously by a counting sort.
+ *  Queries return candidates only; exact overlap tests are left to the
+ *  caller.
+ */
+class Broadphase
+{
+ public:
+  /**
+   *  Constructor.
+   *  @param [in] cell_size The width and height of each grid cell
+   *  @param [in] max_entity_size The largest width or height of an entity
+   */
+  Broadphase(float cell_size, float max_entity_size);
+
+  /**
+   *  Rebuilds the grid.
+   *  @param [in] jobs The job system used to compute the cell keys
+   *  @param [in] area The region covered by the grid, anything outside
+   *  it is placed in the nearest edge cell
+   *  @param [in] count The number of entities
+   *  @param [in] bounds_of Called as bounds_of(index, rect&) and returns
+   *  false for entities that should be left out of the grid
+   */
+  template<typename BoundsOf>
+  void build(JobSystem& jobs,
+             const rect& area,
+             std::size_t count,
+             BoundsOf&& bounds_of)
+  {
+    resize(area, count);
+
+    auto key = [&](std::size_t begin, std::size_t end) {
+      for (std::size_t i = begin; i < end; ++i)
+      {
+        rect bounds;
+        cell_of[i] = bounds_of(i, bounds) ? cellAt(bounds.x, bounds.y) : NONE;
+      }
+    };
+    jobs.parallelFor(0, count, BUILD_GRAIN, key);
+
+    sortIntoCells();
+  }
+
+  /**
+   *  Visits every entity that might overlap an area.
+   *  @param [in] area The area to search
+   *  @param [in] visit Called with the index of each candidate
+   */
+  template<typename Visitor>
+  void query(const rect& area, Visitor&& visit) const
+  {
+    if (cell_start.empty())
+    {
+      return;
+    }
+
+    int min_column = columnAt(area.x - max_size);
+    int max_column = columnAt(area.x + area.length);
+    int min_row = rowAt(area.y - max_size);
+    int max_row = rowAt(area.y + area.height);
+
+    for (int row = min_row; row <= max_row; ++row)
+    {
+      for (int column = min_column; column <= max_column; ++column)
+      {
+        auto cell = static_cast<std::size_t>(row * columns + column);
+        for (auto i = cell_start[cell]; i < cell_start[cell + 1]; ++i)
+        {
+          visit(static_cast<std::size_t>(entities[i]));
+        }
+      }
+    }
+  }
+
+ private:
+  static constexpr std::uint32_t NONE = UINT32_MAX;
+  static constexpr std::size_t BUILD_GRAIN = 1024;
+
+  void resize(const rect& area, std::size_t count);
+  void sortIntoCells();
+  int columnAt(float x) const;
+  int rowAt(float y) const;
+  std::uint32_t cellAt(float x, float y) const;
+
+  float cell_size;
+  float max_size;
+  rect grid_area;
+  int columns = 0;
+  int rows = 0;
+
+  std::vector<std::uint32_t> cell_of;
+  std::vector<std::uint32_t> cell_start;
+  std::vector<std::uint32_t> entities;
+  std::vector<std::uint32_t> cursors;
+};
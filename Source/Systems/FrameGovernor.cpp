@@ -0,0 +1,144 @@
+#include "FrameGovernor.h"
+#include "AsyncLogger.h"
+#include <numeric>
+#include <utility>
+
+/**
+ *   @brief   Sets the target frame rate.
+ *   @details Every subsystem is restored to full quality whenever
+ *            the budget changes.
+ *   @return  void
+ */
+void FrameGovernor::setTargetRate(double fps)
+{
+  budget_ms = fps > 0 ? 1000.0 / fps : 0;
+  frames = 0;
+
+  for (Subsystem& subsystem : subsystems)
+  {
+    if (subsystem.level != 0)
+    {
+      change(subsystem, 0, 0);
+    }
+  }
+}
+
+/**
+ *   @brief   Registers a subsystem with optional work.
+ *   @return  The subsystem's id.
+ */
+int FrameGovernor::addSubsystem(const std::string& name,
+                                int priority,
+                                int max_level,
+                                Apply apply)
+{
+  Subsystem subsystem;
+  subsystem.name = name;
+  subsystem.priority = priority;
+  subsystem.max_level = max_level;
+  subsystem.apply = std::move(apply);
+  subsystem.apply(0);
+
+  subsystems.push_back(std::move(subsystem));
+  return static_cast<int>(subsystems.size()) - 1;
+}
+
+/**
+ *   @brief   Records a frame's work
+ *   @details Frames are kept in a ring the size of the window, and
+ *            no decision is made until the window has filled since
+ *            the last one.
+ *   @return  void
+ */
+void FrameGovernor::endFrame(double work_ms)
+{
+  if (budget_ms <= 0)
+  {
+    return;
+  }
+
+  frame_ms[frames % WINDOW] = work_ms;
+  ++frames;
+
+  if (frames >= WINDOW)
+  {
+    double total = std::accumulate(frame_ms.begin(), frame_ms.end(), 0.0);
+    adjust(total / double(WINDOW));
+  }
+}
+
+/**
+ *   @brief   Gets how far a subsystem has been reduced.
+ *   @return  The subsystem's level.
+ */
+int FrameGovernor::level(int id) const
+{
+  return subsystems[static_cast<std::size_t>(id)].level;
+}
+
+/**
+ *   @brief   Reduces or restores a subsystem
+ *   @details Over budget, the lowest priority subsystem that can
+ *            still be reduced is. With headroom, the highest
+ *            priority one that has been reduced is restored first,
+ *            undoing the reductions in the opposite order.
+ *   @return  void
+ */
+void FrameGovernor::adjust(double mean_ms)
+{
+  Subsystem* chosen = nullptr;
+
+  if (mean_ms > budget_ms * SHED_AT)
+  {
+    for (Subsystem& subsystem : subsystems)
+    {
+      if (subsystem.level < subsystem.max_level &&
+          (!chosen || subsystem.priority < chosen->priority))
+      {
+        chosen = &subsystem;
+      }
+    }
+
+    if (chosen)
+    {
+      change(*chosen, chosen->level + 1, mean_ms);
+    }
+  }
+  else if (mean_ms < budget_ms * RESTORE_AT)
+  {
+    for (Subsystem& subsystem : subsystems)
+    {
+      if (subsystem.level > 0 &&
+          (!chosen || subsystem.priority > chosen->priority))
+      {
+        chosen = &subsystem;
+      }
+    }
+
+    if (chosen)
+    {
+      change(*chosen, chosen->level - 1, mean_ms);
+    }
+  }
+}
+
+/**
+ *   @brief   Applies a subsystem's new level
+ *   @details Logs the decision without blocking the frame and starts a
+ *            new window. Subsystems are never removed, so their names
+ *            outlive the log record.
+ *   @return  void
+ */
+void FrameGovernor::change(Subsystem& subsystem, int level, double mean_ms)
+{
+  AsyncLogger::log("Governor: {} {} to level {} at {}ms of {}ms",
+                   level > subsystem.level ? "reduced" : "restored",
+                   subsystem.name.c_str(),
+                   level,
+                   mean_ms,
+                   budget_ms);
+
+  subsystem.level = level;
+  subsystem.apply(level);
+  frames = 0;
+}
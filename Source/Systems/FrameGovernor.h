@@ -0,0 +1,90 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ *  Scales optional work to keep frames within their budget.
+ *  Subsystems whose work can be reduced without affecting gameplay
+ *  register with a priority and a number of levels they can be reduced
+ *  by. When the rolling frame time nears the budget, the least
+ *  important subsystem is reduced a level, and when there is plenty of
+ *  headroom the most important reduced one is restored. After each
+ *  decision the window starts afresh, so its effect is measured before
+ *  the next one is made. Every decision is logged with a timestamp.
+ *
+ *  Only the time spent working is measured, so a frame that is paced or
+ *  waits for the display isn't mistaken for one that's over budget.
+ */
+class FrameGovernor
+{
+ public:
+  /**
+   *  Applies a subsystem's level, from zero for full quality.
+   */
+  using Apply = std::function<void(int level)>;
+
+  static constexpr std::size_t WINDOW = 30; /**< Frames averaged. */
+  static constexpr double SHED_AT = 0.9;    /**< Share of budget. */
+  static constexpr double RESTORE_AT = 0.6; /**< Share of budget. */
+
+  /**
+   *  Default constructor.
+   */
+  FrameGovernor() = default;
+
+  /**
+   *  Sets the rate frames should be delivered at.
+   *  @param [in] fps The target frame rate, zero or less disables it
+   */
+  void setTargetRate(double fps);
+
+  /**
+   *  Registers a subsystem with optional work.
+   *  Its work is applied at full quality straight away.
+   *  @param [in] name The name used when logging decisions
+   *  @param [in] priority Lower priorities are reduced first
+   *  @param [in] max_level The most the subsystem can be reduced by
+   *  @param [in] apply Called with the new level on every change
+   *  @return the subsystem's id
+   */
+  int addSubsystem(const std::string& name,
+                   int priority,
+                   int max_level,
+                   Apply apply);
+
+  /**
+   *  Records a frame's work and adjusts the subsystems.
+   *  Levels are applied on the calling thread, so this must be called
+   *  while nothing is using the subsystems.
+   *  @param [in] work_ms How long the frame spent working
+   */
+  void endFrame(double work_ms);
+
+  /**
+   *  Gets how far a subsystem has been reduced.
+   *  @param [in] id The subsystem's id
+   *  @return the subsystem's level, zero for full quality
+   */
+  int level(int id) const;
+
+ private:
+  struct Subsystem
+  {
+    std::string name;
+    int priority = 0;
+    int max_level = 0;
+    int level = 0;
+    Apply apply;
+  };
+
+  void adjust(double mean_ms);
+  void change(Subsystem& subsystem, int level, double mean_ms);
+
+  std::vector<Subsystem> subsystems;
+  std::array<double, WINDOW> frame_ms{};
+  std::size_t frames = 0; /**< Frames measured since the last decision. */
+  double budget_ms = 0;
+};
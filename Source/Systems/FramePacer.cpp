@@ -0,0 +1,129 @@
+#include "FramePacer.h"
+#include <algorithm>
+#include <thread>
+
+namespace
+{
+  constexpr auto MIN_SPIN = std::chrono::microseconds(100);
+  constexpr auto MAX_SPIN = std::chrono::milliseconds(4);
+}
+
+/**
+ *   @brief   Sets the target frame rate.
+ *   @details A rate of zero or less removes the cap entirely,
+ *            which is useful when benchmarking.
+ *   @return  void
+ */
+void FramePacer::setTargetRate(double fps)
+{
+  if (fps <= 0)
+  {
+    period = clock::duration::zero();
+  }
+  else
+  {
+    period = std::chrono::duration_cast<clock::duration>(
+      std::chrono::duration<double>(1.0 / fps));
+  }
+
+  reset();
+}
+
+/**
+ *   @brief   Waits for the next frame deadline.
+ *   @details Sleeps until spin_margin before the deadline and then
+ *            spins. Any oversleep is fed back into the margin so the
+ *            next sleep wakes up early enough. Frames that start more
+ *            than a whole period late are counted as missed and the
+ *            schedule restarts from the current time.
+ *   @return  void
+ */
+void FramePacer::waitForNextFrame()
+{
+  if (period == clock::duration::zero())
+  {
+    return;
+  }
+
+  auto now = clock::now();
+  if (!scheduled)
+  {
+    deadline = now + period;
+    scheduled = true;
+    return;
+  }
+
+  auto wake_at = deadline - spin_margin;
+  if (now < wake_at)
+  {
+    std::this_thread::sleep_until(wake_at);
+
+    // the margin settles on twice the typical oversleep
+    auto oversleep = clock::now() - wake_at;
+    spin_margin = std::clamp<clock::duration>(
+      (spin_margin * 7 + oversleep * 2) / 8, MIN_SPIN, MAX_SPIN);
+  }
+
+  while ((now = clock::now()) < deadline)
+  {
+  }
+
+  auto lateness = now - deadline;
+  record(lateness);
+
+  if (lateness > period)
+  {
+    pacing_stats.missed++;
+    deadline = now + period;
+  }
+  else
+  {
+    deadline += period;
+  }
+}
+
+/**
+ *   @brief   Restarts the schedule.
+ *   @details The next call to waitForNextFrame begins a new
+ *            schedule rather than catching up.
+ *   @return  void
+ */
+void FramePacer::reset()
+{
+  scheduled = false;
+}
+
+/**
+ *   @brief   Gets the pacing statistics.
+ *   @return  The jitter measured for each paced frame.
+ */
+const PacingStats& FramePacer::stats() const
+{
+  return pacing_stats;
+}
+
+/**
+ *   @brief   Clears the pacing statistics.
+ *   @return  void
+ */
+void FramePacer::clearStats()
+{
+  pacing_stats = PacingStats();
+}
+
+/**
+ *   @brief   Records a frame's jitter.
+ *   @details Keeps a running mean and the worst case in microseconds.
+ *   @return  void
+ */
+void FramePacer::record(clock::duration lateness)
+{
+  double jitter_us =
+    std::chrono::duration<double, std::micro>(lateness).count();
+
+  pacing_stats.frames++;
+  pacing_stats.mean_jitter_us +=
+    (jitter_us - pacing_stats.mean_jitter_us) /
+    static_cast<double>(pacing_stats.frames);
+  pacing_stats.max_jitter_us = std::max(pacing_stats.max_jitter_us, jitter_us);
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+/**
+ *  Pacing statistics gathered by the FramePacer.
+ *  Jitter is how late a frame started compared to its deadline.
+ */
+struct PacingStats
+{
+  std::uint64_t frames = 0;
+  std::uint64_t missed = 0;
+  double mean_jitter_us = 0;
+  double max_jitter_us = 0;
+};
+
+/**
+ *  Paces the game loop to a target frame rate.
+ *  Sleeping alone is too coarse to hit a deadline accurately, so the
+ *  pacer sleeps until it is just short of the deadline and spins for the
+ *  remainder. The spin margin adapts to how badly the OS oversleeps,
+ *  keeping the busy-wait as short as possible.
+ */
+class FramePacer
+{
+ public:
+  using clock = std::chrono::steady_clock;
+
+  /**
+   *  Default constructor.
+   */
+  FramePacer() = default;
+
+  /**
+   *  Sets the rate frames should be delivered at.
+   *  @param [in] fps The target frame rate, zero or less for uncapped
+   */
+  void setTargetRate(double fps);
+
+  /**
+   *  Blocks until the next frame is due.
+   *  Returns immediately when uncapped or running behind.
+   */
+  void waitForNextFrame();
+
+  /**
+   *  Restarts the schedule from now.
+   *  Used after the loop has been blocked elsewhere, so the pacer
+   *  doesn't try and catch up on frames that were never meant to run.
+   */
+  void reset();
+
+  /**
+   *  Returns the jitter measured since the statistics were last cleared.
+   *  @return the pacing statistics
+   */
+  const PacingStats& stats() const;
+
+  /**
+   *  Clears the gathered statistics.
+   */
+  void clearStats();
+
+ private:
+  void record(clock::duration lateness);
+
+  clock::duration period = clock::duration::zero();
+  clock::duration spin_margin = std::chrono::milliseconds(1);
+  clock::time_point deadline{};
+  bool scheduled = false;
+
+  PacingStats pacing_stats;
+};
@@ -0,0 +1,114 @@
+#include "HdrHistogram.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ *   @brief   Adds a duration.
+ *   @return  void
+ */
+void HdrHistogram::record(std::uint64_t us)
+{
+  ++counts[bucketOf(us)];
+  ++total;
+  largest = std::max(largest, us);
+  sum += double(us);
+}
+
+/**
+ *   @brief   Finds a percentile.
+ *   @details Walks the buckets until the fraction of durations has
+ *            been passed, and reports the top of that bucket.
+ *   @return  The percentile in microseconds.
+ */
+std::uint64_t HdrHistogram::percentile(double fraction) const
+{
+  if (total == 0)
+  {
+    return 0;
+  }
+
+  auto target = static_cast<std::uint64_t>(
+    std::ceil(fraction * static_cast<double>(total)));
+  target = std::max<std::uint64_t>(1, target);
+
+  std::uint64_t seen = 0;
+  for (std::size_t i = 0; i < counts.size(); ++i)
+  {
+    seen += counts[i];
+    if (seen >= target)
+    {
+      return std::min(largest, bucketTop(i));
+    }
+  }
+
+  return largest;
+}
+
+/**
+ *   @brief   Counts the durations above a threshold.
+ *   @details Every bucket that starts above the threshold is counted.
+ *   @return  The number of durations above the threshold.
+ */
+std::uint64_t HdrHistogram::countAbove(std::uint64_t us) const
+{
+  std::uint64_t above = 0;
+  for (std::size_t i = bucketOf(us) + 1; i < counts.size(); ++i)
+  {
+    above += counts[i];
+  }
+  return above;
+}
+
+/**
+ *   @brief   Gets the mean duration.
+ *   @return  The mean in microseconds.
+ */
+double HdrHistogram::mean() const
+{
+  return total > 0 ? sum / double(total) : 0;
+}
+
+/**
+ *   @brief   Finds the bucket a duration belongs in.
+ *   @details Small durations index the buckets directly. Larger ones
+ *            are shifted right until they fit in the top half of the
+ *            sub-buckets, and the shift picks which power of two's
+ *            buckets to use.
+ *   @return  The bucket's index.
+ */
+std::size_t HdrHistogram::bucketOf(std::uint64_t us)
+{
+  us = std::min(us, (std::uint64_t(1) << MAX_BITS) - 1);
+  if (us < SUB_BUCKETS)
+  {
+    return static_cast<std::size_t>(us);
+  }
+
+  int shift = 1;
+  while ((us >> shift) >= SUB_BUCKETS)
+  {
+    ++shift;
+  }
+
+  std::uint64_t half = SUB_BUCKETS / 2;
+  return static_cast<std::size_t>(SUB_BUCKETS +
+                                  std::uint64_t(shift - 1) * half +
+                                  (us >> shift) - half);
+}
+
+/**
+ *   @brief   Finds the largest duration a bucket holds.
+ *   @return  The top of the bucket in microseconds.
+ */
+std::uint64_t HdrHistogram::bucketTop(std::size_t bucket)
+{
+  if (bucket < SUB_BUCKETS)
+  {
+    return bucket;
+  }
+
+  std::uint64_t half = SUB_BUCKETS / 2;
+  std::uint64_t shift = (bucket - SUB_BUCKETS) / half + 1;
+  std::uint64_t base = (bucket - SUB_BUCKETS) % half + half;
+  return ((base + 1) << shift) - 1;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+/**
+ *  A high dynamic range histogram of durations in microseconds.
+ *  Buckets are log-linear: values below SUB_BUCKETS each get their own
+ *  bucket, and every power of two above that is split into
+ *  SUB_BUCKETS / 2 equal buckets. Any recorded value can be recovered
+ *  to within 1 part in 256 whether it is a microsecond or an hour. The
+ *  memory used is fixed, recording never allocates, and histograms from
+ *  different builds and machines share the same buckets so they can be
+ *  compared directly.
+ */
+class HdrHistogram
+{
+ public:
+  static constexpr int SUB_BUCKET_BITS = 9;
+  static constexpr std::uint64_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+  static constexpr int MAX_BITS = 36; /**< About 19 hours, then clamped. */
+
+  /**
+   *  Adds a duration.
+   *  @param [in] us The duration in microseconds
+   */
+  void record(std::uint64_t us);
+
+  /**
+   *  Finds the duration that a fraction of those recorded are within.
+   *  @param [in] fraction From 0 to 1, such as 0.99 for the 99th
+   *  @return the top of the bucket the percentile falls in, never more
+   *          than the longest duration recorded
+   */
+  std::uint64_t percentile(double fraction) const;
+
+  /**
+   *  Counts the durations longer than a threshold.
+   *  Accurate to the width of the bucket the threshold falls in.
+   *  @param [in] us The threshold in microseconds
+   *  @return the number of durations recorded above it
+   */
+  std::uint64_t countAbove(std::uint64_t us) const;
+
+  std::uint64_t count() const { return total; }
+  std::uint64_t max() const { return largest; }
+
+  /**
+   *  Gets the mean duration.
+   *  @return the exact mean in microseconds, or zero if empty
+   */
+  double mean() const;
+
+ private:
+  static constexpr std::size_t BUCKETS =
+    SUB_BUCKETS + (MAX_BITS - SUB_BUCKET_BITS) * (SUB_BUCKETS / 2);
+
+  static std::size_t bucketOf(std::uint64_t us);
+  static std::uint64_t bucketTop(std::size_t bucket);
+
+  std::array<std::uint64_t, BUCKETS> counts{};
+  std::uint64_t total = 0;
+  std::uint64_t largest = 0;
+  double sum = 0;
+};
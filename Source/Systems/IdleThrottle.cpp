@@ -0,0 +1,67 @@
+#include "IdleThrottle.h"
+
+// provided by the GLFW library the engine is built upon
+extern "C" void glfwWaitEventsTimeout(double timeout);
+
+/**
+ *   @brief   Sets the wake timer.
+ *   @details The loop will never block for longer than this.
+ *   @return  void
+ */
+void IdleThrottle::setTimeout(std::chrono::milliseconds timeout_)
+{
+  timeout = timeout_;
+}
+
+/**
+ *   @brief   Is the scene unchanged since it was presented?
+ *   @details Double buffering means a new scene must be presented
+ *            more than once before every buffer holds it, so the
+ *            scene only counts as idle after it has been seen for
+ *            PRESENTS_REQUIRED frames in a row.
+ *   @return  True if the loop can safely block.
+ */
+bool IdleThrottle::isIdle(bool is_static, std::size_t fingerprint)
+{
+  resumed = waited;
+  waited = false;
+
+  if (!is_static || fingerprint != last_fingerprint)
+  {
+    last_fingerprint = fingerprint;
+    times_presented = 0;
+    return false;
+  }
+
+  if (times_presented < PRESENTS_REQUIRED)
+  {
+    ++times_presented;
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ *   @brief   Waits for input.
+ *   @details The engine only polls for events when a frame begins.
+ *            Waiting here lets the OS put the thread to sleep and
+ *            dispatches any event that wakes it to the input handlers.
+ *   @return  void
+ */
+void IdleThrottle::waitForEvents()
+{
+  std::chrono::duration<double> seconds = timeout;
+  glfwWaitEventsTimeout(seconds.count());
+  waited = true;
+}
+
+/**
+ *   @brief   Did the previous frame block?
+ *   @details Used to clamp the oversized delta that follows a wait.
+ *   @return  True if the loop was asleep before this frame.
+ */
+bool IdleThrottle::resumedFromIdle() const
+{
+  return resumed;
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+
+/**
+ *  Throttles the game loop whilst a static scene is on screen.
+ *  Menus and end screens only show fixed text, yet the engine loop
+ *  keeps spinning at full speed. The throttle compares a fingerprint of
+ *  the scene against the previously presented frames and, once nothing
+ *  has changed, blocks the loop until the next input event arrives or
+ *  the wake timer expires.
+ */
+class IdleThrottle
+{
+ public:
+  /**
+   *  Default constructor.
+   */
+  IdleThrottle() = default;
+
+  /**
+   *  Sets the longest time the loop may block whilst idle.
+   *  @param [in] timeout The wake timer used when no input arrives
+   */
+  void setTimeout(std::chrono::milliseconds timeout);
+
+  /**
+   *  Records the fingerprint of the scene about to be presented.
+   *  The scene is considered idle once it is static and its fingerprint
+   *  has been presented often enough to have reached every buffer.
+   *  @param [in] is_static Whether the scene is a fixed, non-animated one
+   *  @param [in] fingerprint A hash of everything visible in the scene
+   *  @return true if the scene has not changed since it was last presented
+   */
+  bool isIdle(bool is_static, std::size_t fingerprint);
+
+  /**
+   *  Blocks until an input event is received or the timer expires.
+   *  Any events are dispatched to the registered input callbacks
+   *  before this function returns.
+   */
+  void waitForEvents();
+
+  /**
+   *  Was the loop blocked before the current frame?
+   *  The frame delta following a wait spans the time spent asleep, so
+   *  simulation should not be advanced by all of it.
+   *  @return true if the previous frame waited for events
+   */
+  bool resumedFromIdle() const;
+
+ private:
+  static constexpr int PRESENTS_REQUIRED = 2;
+
+  std::chrono::milliseconds timeout{ 250 };
+  std::size_t last_fingerprint = 0;
+  int times_presented = 0;
+  bool waited = false;
+  bool resumed = false;
+};
@@ -0,0 +1,94 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+/**
+ *  A key event copied out of the engine's callback.
+ */
+struct InputEvent
+{
+  int key = -1;
+  int action = -1;
+  int mods = 0;
+  std::chrono::steady_clock::time_point timestamp; /**< When it arrived. */
+};
+
+/**
+ *  A fixed-size, lock-free queue of input events.
+ *  A single producer, the engine's input callback, pushes events and a
+ *  single consumer, the simulation, pops them. The engine may use a new
+ *  thread for each callback, but only ever runs one at a time, so there
+ *  is still only one producer at any moment. Neither side allocates or
+ *  locks. Events arriving whilst the queue is full are dropped.
+ */
+class InputQueue
+{
+ public:
+  static constexpr std::size_t CAPACITY = 256;
+
+  /**
+   *  Adds an event to the queue. Producer only.
+   *  @param [in] event The event to copy into the queue
+   *  @return false if the queue was full and the event was dropped
+   */
+  bool push(const InputEvent& event)
+  {
+    std::size_t tail = write.load(std::memory_order_relaxed);
+    if (tail - read.load(std::memory_order_acquire) == CAPACITY)
+    {
+      dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    events[tail % CAPACITY] = event;
+    write.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   *  Takes the oldest event from the queue. Consumer only.
+   *  @param [out] event Receives the event
+   *  @return false if the queue was empty
+   */
+  bool pop(InputEvent& event)
+  {
+    std::size_t head = read.load(std::memory_order_relaxed);
+    if (head == write.load(std::memory_order_acquire))
+    {
+      return false;
+    }
+
+    event = events[head % CAPACITY];
+    read.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   *  Checks for waiting events. Safe to call from any thread.
+   *  @return true if nothing is waiting to be popped
+   */
+  bool empty() const
+  {
+    return read.load(std::memory_order_acquire) ==
+           write.load(std::memory_order_acquire);
+  }
+
+  /**
+   *  Gets the number of events lost to a full queue.
+   *  @return the dropped event count
+   */
+  std::size_t droppedCount() const
+  {
+    return dropped.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::array<InputEvent, CAPACITY> events;
+
+  // kept on separate cache lines so the two threads don't contend
+  alignas(64) std::atomic<std::size_t> write{ 0 };
+  alignas(64) std::atomic<std::size_t> read{ 0 };
+  alignas(64) std::atomic<std::size_t> dropped{ 0 };
+};
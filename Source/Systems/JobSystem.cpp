@@ -0,0 +1,263 @@
+#include "JobSystem.h"
+#include "SamplingProfiler.h"
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+  // the job system and queue the current thread works for, if any
+  thread_local const JobSystem* worker_owner = nullptr;
+  thread_local std::size_t worker_queue = 0;
+
+  // splitting a range more finely than this only adds overhead
+  constexpr std::size_t SPLITS_PER_THREAD = 8;
+}
+
+/**
+ *   @brief   Constructor.
+ *   @details Queue zero is shared by any thread outside the system,
+ *            normally the main thread. Every worker gets its own.
+ *   @return  void
+ */
+JobSystem::JobSystem(unsigned int workers)
+{
+  for (unsigned int i = 0; i <= workers; ++i)
+  {
+    queues.push_back(std::make_unique<WorkQueue>());
+  }
+
+  for (unsigned int i = 1; i <= workers; ++i)
+  {
+    threads.emplace_back(&JobSystem::workerLoop, this, std::size_t(i));
+  }
+}
+
+/**
+ *   @brief   Destructor.
+ *   @details Wakes every worker so it can exit and then joins them.
+ */
+JobSystem::~JobSystem()
+{
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex);
+    stopping = true;
+  }
+
+  wake.notify_all();
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+}
+
+/**
+ *   @brief   Waits for a group of jobs.
+ *   @details Rather than block, the waiting thread keeps running
+ *            jobs, which may well be the ones it is waiting for.
+ *   @return  void
+ */
+void JobSystem::wait(JobCounter& counter)
+{
+  std::size_t queue = currentQueue();
+
+  while (!counter.done())
+  {
+    Job job;
+    if (findJob(queue, job))
+    {
+      execute(job);
+    }
+    else
+    {
+      std::this_thread::yield();
+    }
+  }
+}
+
+/**
+ *   @brief   Gets the number of threads that execute jobs.
+ *   @return  The worker count plus one for the scheduling thread.
+ */
+std::size_t JobSystem::concurrency() const
+{
+  return queues.size();
+}
+
+/**
+ *   @brief   Picks a chunk size for a range.
+ *   @details Aims for a handful of chunks per thread so stealing can
+ *            balance the load, without going below the minimum grain.
+ *   @return  The largest range a single job should process.
+ */
+std::size_t JobSystem::grainFor(std::size_t count, std::size_t min_grain) const
+{
+  std::size_t chunks = concurrency() * SPLITS_PER_THREAD;
+  return std::max(min_grain, (count + chunks - 1) / chunks);
+}
+
+/**
+ *   @brief   Finds the queue owned by the calling thread.
+ *   @return  The worker's own queue, or zero for outside threads.
+ */
+std::size_t JobSystem::currentQueue() const
+{
+  return worker_owner == this ? worker_queue : 0;
+}
+
+/**
+ *   @brief   Queues a job on the calling thread's deque.
+ *   @details The counter is incremented before the job is visible
+ *            to any other thread. A full deque runs the job inline.
+ *   @return  void
+ */
+void JobSystem::push(const Job& job)
+{
+  job.counter->pending.fetch_add(1, std::memory_order_relaxed);
+  queued.fetch_add(1, std::memory_order_release);
+
+  if (!pushBack(currentQueue(), job))
+  {
+    queued.fetch_sub(1, std::memory_order_relaxed);
+    execute(job);
+    return;
+  }
+
+  wake.notify_one();
+}
+
+/**
+ *   @brief   Adds a job to the back of a deque.
+ *   @return  False if the deque is full.
+ */
+bool JobSystem::pushBack(std::size_t queue, const Job& job)
+{
+  WorkQueue& work = *queues[queue];
+  std::lock_guard<std::mutex> lock(work.mutex);
+
+  if (work.size == WorkQueue::CAPACITY)
+  {
+    return false;
+  }
+
+  work.jobs[(work.head + work.size) % WorkQueue::CAPACITY] = job;
+  ++work.size;
+  return true;
+}
+
+/**
+ *   @brief   Takes the newest job from the back of a deque.
+ *   @return  True if a job was taken.
+ */
+bool JobSystem::popBack(std::size_t queue, Job& job)
+{
+  WorkQueue& work = *queues[queue];
+  std::lock_guard<std::mutex> lock(work.mutex);
+
+  if (work.size == 0)
+  {
+    return false;
+  }
+
+  --work.size;
+  job = work.jobs[(work.head + work.size) % WorkQueue::CAPACITY];
+  return true;
+}
+
+/**
+ *   @brief   Steals the oldest job from the front of a deque.
+ *   @details The oldest job is the least split, so a thief walks
+ *            away with as much work as possible.
+ *   @return  True if a job was stolen.
+ */
+bool JobSystem::stealFront(std::size_t queue, Job& job)
+{
+  WorkQueue& work = *queues[queue];
+  std::unique_lock<std::mutex> lock(work.mutex, std::try_to_lock);
+
+  if (!lock.owns_lock() || work.size == 0)
+  {
+    return false;
+  }
+
+  job = work.jobs[work.head];
+  work.head = (work.head + 1) % WorkQueue::CAPACITY;
+  --work.size;
+  return true;
+}
+
+/**
+ *   @brief   Finds a job to run.
+ *   @details Checks the thread's own deque first and then tries
+ *            each of the others in turn.
+ *   @return  True if a job was found.
+ */
+bool JobSystem::findJob(std::size_t queue, Job& job)
+{
+  if (queued.load(std::memory_order_acquire) == 0)
+  {
+    return false;
+  }
+
+  bool found = popBack(queue, job);
+  for (std::size_t i = 1; !found && i < queues.size(); ++i)
+  {
+    found = stealFront((queue + i) % queues.size(), job);
+  }
+
+  if (found)
+  {
+    queued.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  return found;
+}
+
+/**
+ *   @brief   Runs a job.
+ *   @details Ranges larger than the grain are halved, with the upper
+ *            half pushed back onto the deque for anyone to steal,
+ *            until what remains is small enough to process.
+ *   @return  void
+ */
+void JobSystem::execute(Job job)
+{
+  while (job.end - job.begin > job.grain)
+  {
+    Job upper = job;
+    upper.begin = job.begin + (job.end - job.begin) / 2;
+    job.end = upper.begin;
+    push(upper);
+  }
+
+  job.function(job.data, job.begin, job.end);
+  job.counter->pending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+/**
+ *   @brief   The worker thread's main loop.
+ *   @details Runs jobs whilst any are available and sleeps once
+ *            there are none. The timed wait guards against missing
+ *            a wake-up that raced with going to sleep.
+ *   @return  void
+ */
+void JobSystem::workerLoop(std::size_t queue)
+{
+  worker_owner = this;
+  worker_queue = queue;
+  SamplingProfiler::registerThread();
+
+  while (!stopping)
+  {
+    Job job;
+    if (findJob(queue, job))
+    {
+      execute(job);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(sleep_mutex);
+    wake.wait_for(lock, std::chrono::milliseconds(1), [this] {
+      return stopping || queued.load(std::memory_order_acquire) > 0;
+    });
+  }
+}
@@ -0,0 +1,173 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ *  Tracks a group of jobs so their completion can be waited upon.
+ *  Every job scheduled against a counter increments it, and each
+ *  finished job decrements it, so the group is done at zero.
+ */
+class JobCounter
+{
+ public:
+  bool done() const { return pending.load(std::memory_order_acquire) == 0; }
+
+ private:
+  friend class JobSystem;
+  std::atomic<std::size_t> pending{ 0 };
+};
+
+/**
+ *  A work-stealing job system.
+ *  Each worker owns a deque of jobs. Workers push and pop from the back
+ *  of their own deque and, once it runs dry, steal from the front of
+ *  another's where the largest pieces of work sit. Jobs are ranges of
+ *  indices which split themselves in half until they are no larger
+ *  than their grain, so busy workers hand off work lazily and only when
+ *  someone is free to take it. Threads that wait on a counter help out
+ *  by running jobs rather than sleeping.
+ */
+class JobSystem
+{
+ public:
+  using Function = void (*)(void* data, std::size_t begin, std::size_t end);
+
+  /**
+   *  Constructor. Starts the worker threads.
+   *  @param [in] workers The number of threads to start, in addition to
+   *  the thread that schedules work. Zero runs everything inline.
+   */
+  explicit JobSystem(unsigned int workers);
+
+  /**
+   *  Destructor. Stops and joins the worker threads.
+   */
+  ~JobSystem();
+
+  JobSystem(const JobSystem&) = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+
+  /**
+   *  Schedules a range of work without waiting for it.
+   *  The callable is not copied and must outlive the counter's wait.
+   *  @param [in] counter Incremented for every job the range becomes
+   *  @param [in] begin The first index in the range
+   *  @param [in] end One past the last index in the range
+   *  @param [in] grain The largest range a single job will process
+   *  @param [in] function Called with each sub-range as (begin, end)
+   */
+  template<typename Callable>
+  void schedule(JobCounter& counter,
+                std::size_t begin,
+                std::size_t end,
+                std::size_t grain,
+                Callable& function)
+  {
+    push(Job{ &invoke<Callable>,
+              &function,
+              begin,
+              end,
+              grain == 0 ? 1 : grain,
+              &counter });
+  }
+
+  /**
+   *  Runs jobs until every job tracked by the counter has finished.
+   *  @param [in] counter The counter to wait on
+   */
+  void wait(JobCounter& counter);
+
+  /**
+   *  Runs a function over a range of indices in parallel.
+   *  The chunk size adapts to the size of the range and the number of
+   *  threads, but never drops below the minimum grain. Ranges no larger
+   *  than the minimum grain run inline without touching the workers.
+   *  @param [in] begin The first index in the range
+   *  @param [in] end One past the last index in the range
+   *  @param [in] min_grain The smallest range worth handing to a thread
+   *  @param [in] function Called with each sub-range as (begin, end)
+   */
+  template<typename Callable>
+  void parallelFor(std::size_t begin,
+                   std::size_t end,
+                   std::size_t min_grain,
+                   Callable&& function)
+  {
+    if (end <= begin)
+    {
+      return;
+    }
+
+    std::size_t count = end - begin;
+    if (count <= min_grain || queues.size() == 1)
+    {
+      function(begin, end);
+      return;
+    }
+
+    JobCounter counter;
+    schedule(counter, begin, end, grainFor(count, min_grain), function);
+    wait(counter);
+  }
+
+  /**
+   *  Gets the number of threads that execute jobs.
+   *  @return the workers plus the scheduling thread
+   */
+  std::size_t concurrency() const;
+
+ private:
+  struct Job
+  {
+    Function function = nullptr;
+    void* data = nullptr;
+    std::size_t begin = 0;
+    std::size_t end = 0;
+    std::size_t grain = 1;
+    JobCounter* counter = nullptr;
+  };
+
+  /**
+   *  A fixed capacity deque. The owner works at the back, thieves
+   *  take from the front. Full deques make the owner run jobs inline.
+   */
+  struct WorkQueue
+  {
+    static constexpr std::size_t CAPACITY = 1024;
+
+    std::mutex mutex;
+    std::array<Job, CAPACITY> jobs;
+    std::size_t head = 0;
+    std::size_t size = 0;
+  };
+
+  template<typename Callable>
+  static void invoke(void* data, std::size_t begin, std::size_t end)
+  {
+    (*static_cast<Callable*>(data))(begin, end);
+  }
+
+  std::size_t grainFor(std::size_t count, std::size_t min_grain) const;
+  std::size_t currentQueue() const;
+  void push(const Job& job);
+  bool pushBack(std::size_t queue, const Job& job);
+  bool popBack(std::size_t queue, Job& job);
+  bool stealFront(std::size_t queue, Job& job);
+  bool findJob(std::size_t queue, Job& job);
+  void execute(Job job);
+  void workerLoop(std::size_t queue);
+
+  std::vector<std::unique_ptr<WorkQueue>> queues;
+  std::vector<std::thread> threads;
+
+  std::mutex sleep_mutex;
+  std::condition_variable wake;
+  std::atomic<std::size_t> queued{ 0 };
+  std::atomic<bool> stopping{ false };
+};
@@ -0,0 +1,112 @@
+#include "LatencyTracker.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ *   @brief   Constructor.
+ *   @details The histograms are allocated up front, with one bucket
+ *            beyond the last to catch anything longer.
+ */
+LatencyTracker::LatencyTracker()
+{
+  for (auto& histogram : histograms)
+  {
+    histogram.counts.assign(BUCKETS + 1, 0);
+  }
+}
+
+/**
+ *   @brief   Records an event reaching a stage.
+ *   @return  void
+ */
+void LatencyTracker::record(Stage stage,
+                            clock::time_point arrived,
+                            clock::time_point now)
+{
+  double latency_us =
+    std::chrono::duration<double, std::micro>(now - arrived).count();
+  latency_us = std::max(0.0, latency_us);
+
+  auto bucket = static_cast<std::size_t>(latency_us / BUCKET_US);
+  Histogram& histogram = histograms[stage];
+  ++histogram.counts[std::min(bucket, BUCKETS)];
+  ++histogram.events;
+  histogram.max_us = std::max(histogram.max_us, latency_us);
+}
+
+/**
+ *   @brief   Counts events that reached a stage without being timed.
+ *   @return  void
+ */
+void LatencyTracker::leaveOut(Stage stage, std::size_t count)
+{
+  histograms[stage].left_out += count;
+}
+
+/**
+ *   @brief   Summarises a stage.
+ *   @return  The stage's latency statistics.
+ */
+LatencyStats LatencyTracker::stats(Stage stage) const
+{
+  const Histogram& histogram = histograms[stage];
+
+  LatencyStats stats;
+  stats.events = histogram.events;
+  stats.left_out = histogram.left_out;
+  stats.p50_us = percentile(histogram, 0.5);
+  stats.p99_us = percentile(histogram, 0.99);
+  stats.max_us = histogram.max_us;
+  return stats;
+}
+
+/**
+ *   @brief   Names a stage.
+ *   @return  The stage's name.
+ */
+const char* LatencyTracker::stageName(Stage stage)
+{
+  switch (stage)
+  {
+    case APPLIED:
+      return "applied";
+    case SUBMITTED:
+      return "submitted";
+    case PRESENTED:
+      return "presented";
+    default:
+      return "unknown";
+  }
+}
+
+/**
+ *   @brief   Finds a percentile of a histogram.
+ *   @details Walks the buckets until the fraction of events has been
+ *            passed, and reports the top of that bucket. The result
+ *            never exceeds the largest latency actually seen.
+ *   @return  The percentile in microseconds.
+ */
+double LatencyTracker::percentile(const Histogram& histogram,
+                                  double fraction) const
+{
+  if (histogram.events == 0)
+  {
+    return 0;
+  }
+
+  auto target = static_cast<std::uint64_t>(
+    std::ceil(fraction * static_cast<double>(histogram.events)));
+  target = std::max<std::uint64_t>(1, target);
+
+  std::uint64_t seen = 0;
+  for (std::size_t i = 0; i < histogram.counts.size(); ++i)
+  {
+    seen += histogram.counts[i];
+    if (seen >= target)
+    {
+      return std::min(histogram.max_us, double(i + 1) * BUCKET_US);
+    }
+  }
+
+  return histogram.max_us;
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+/**
+ *  Latency statistics for one stage of the input pipeline.
+ *  Percentiles are accurate to the width of a histogram bucket.
+ */
+struct LatencyStats
+{
+  std::uint64_t events = 0;
+  std::uint64_t left_out = 0; /**< Events that reached it untimed. */
+  double p50_us = 0;
+  double p99_us = 0;
+  double max_us = 0;
+};
+
+/**
+ *  Measures how long input takes to reach the screen.
+ *  Every input event carries the time it arrived. As it passes each
+ *  stage of the pipeline, the time since it arrived is added to that
+ *  stage's histogram. Each stage is only recorded by one thread, so no
+ *  locking is needed, but statistics should only be read once the game
+ *  has stopped.
+ */
+class LatencyTracker
+{
+ public:
+  using clock = std::chrono::steady_clock;
+
+  enum Stage
+  {
+    APPLIED,   /**< Applied to the game by the simulation. */
+    SUBMITTED, /**< Drawn as part of a frame's render list. */
+    PRESENTED, /**< The frame containing it was swapped on screen. */
+    STAGE_COUNT
+  };
+
+  /**
+   *  Default constructor.
+   */
+  LatencyTracker();
+
+  /**
+   *  Records an event reaching a stage.
+   *  @param [in] stage The stage that was reached
+   *  @param [in] arrived When the input event arrived
+   *  @param [in] now When the stage was reached
+   */
+  void record(Stage stage, clock::time_point arrived, clock::time_point now);
+
+  /**
+   *  Counts events that reached a stage without being timed.
+   *  @param [in] stage The stage that was reached
+   *  @param [in] count The number of events left out
+   */
+  void leaveOut(Stage stage, std::size_t count);
+
+  /**
+   *  Gets the statistics for a stage.
+   *  @param [in] stage The stage to summarise
+   *  @return the event counts, median, 99th percentile and maximum
+   */
+  LatencyStats stats(Stage stage) const;
+
+  /**
+   *  Gets a stage's name for reports.
+   *  @param [in] stage The stage to name
+   *  @return the name of the stage
+   */
+  static const char* stageName(Stage stage);
+
+ private:
+  static constexpr double BUCKET_US = 50;
+  static constexpr std::size_t BUCKETS = 5000; // 250ms, then overflow
+
+  struct Histogram
+  {
+    std::vector<std::uint32_t> counts;
+    std::uint64_t events = 0;
+    std::uint64_t left_out = 0;
+    double max_us = 0;
+  };
+
+  double percentile(const Histogram& histogram, double fraction) const;
+
+  std::array<Histogram, STAGE_COUNT> histograms;
+};
@@ -0,0 +1,302 @@
+#include "PerfCounters.h"
+#include <atomic>
+#include <mutex>
+
+#ifdef __linux__
+#  include <cstring>
+#  include <linux/perf_event.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
+namespace
+{
+  struct PhaseTotals
+  {
+    std::atomic<std::uint64_t> runs{ 0 };
+    std::atomic<std::uint64_t> entities{ 0 };
+    std::array<std::atomic<std::uint64_t>, PerfCounters::COUNTER_COUNT>
+      counts{};
+  };
+
+  std::mutex phase_mutex;
+  std::array<std::string, PerfCounters::MAX_PHASES> phase_names;
+  std::array<PhaseTotals, PerfCounters::MAX_PHASES> totals;
+  std::atomic<int> phase_count{ 0 };
+
+  std::atomic<bool> counting{ false };
+  std::atomic<unsigned> available{ 0 }; /**< Bit per Counter opened. */
+
+#ifdef __linux__
+  struct EventConfig
+  {
+    std::uint32_t type;
+    std::uint64_t config;
+  };
+
+  constexpr std::uint64_t cacheReadMiss(std::uint64_t cache)
+  {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+           (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  }
+
+  constexpr std::array<EventConfig, PerfCounters::COUNTER_COUNT> EVENTS{ {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HW_CACHE, cacheReadMiss(PERF_COUNT_HW_CACHE_L1D) },
+    { PERF_TYPE_HW_CACHE, cacheReadMiss(PERF_COUNT_HW_CACHE_LL) },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+  } };
+
+  int openEvent(const EventConfig& event, int group)
+  {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = event.type;
+    attr.config = event.config;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                       PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    // only the calling thread, on whichever core it runs
+    return static_cast<int>(
+      syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+  }
+
+  /**
+   *  The calling thread's counters, opened on first use and closed
+   *  when the thread exits.
+   */
+  struct ThreadGroup
+  {
+    std::array<int, PerfCounters::COUNTER_COUNT> fds{};
+    std::array<int, PerfCounters::COUNTER_COUNT> order{}; /**< Counters. */
+    int members = 0;
+    bool opened = false;
+
+    ThreadGroup() { fds.fill(-1); }
+
+    ~ThreadGroup()
+    {
+      for (int fd : fds)
+      {
+        if (fd >= 0)
+        {
+          close(fd);
+        }
+      }
+    }
+
+    bool open()
+    {
+      if (opened)
+      {
+        return fds[0] >= 0;
+      }
+      opened = true;
+
+      // cycles lead the group, and the rest are optional
+      for (std::size_t i = 0; i < EVENTS.size(); ++i)
+      {
+        fds[i] = openEvent(EVENTS[i], i == 0 ? -1 : fds[0]);
+        if (fds[i] >= 0)
+        {
+          order[static_cast<std::size_t>(members++)] = static_cast<int>(i);
+        }
+        else if (i == 0)
+        {
+          return false;
+        }
+      }
+      return true;
+    }
+  };
+
+  ThreadGroup& threadGroup()
+  {
+    thread_local ThreadGroup group;
+    return group;
+  }
+#endif
+}
+
+/**
+ *   @brief   Gets the instructions per cycle
+ *   @return  The IPC, or -1 if it can't be worked out.
+ */
+double CounterStats::ipc() const
+{
+  return cycles > 0 && instructions >= 0 ? instructions / cycles : -1;
+}
+
+/**
+ *   @brief   Spreads a total over every entity processed
+ *   @return  The total per entity, or -1 if it is unavailable.
+ */
+double CounterStats::perEntity(double total) const
+{
+  return total >= 0 && entities > 0 ? total / double(entities) : -1;
+}
+
+/**
+ *   @brief   Starts counting
+ *   @details Opens the calling thread's counters to find out which
+ *            of them the kernel will provide. Other threads are
+ *            assumed to be offered the same.
+ *   @return  True if counting is enabled.
+ */
+bool PerfCounters::enable()
+{
+#ifdef __linux__
+  ThreadGroup& group = threadGroup();
+  if (group.open())
+  {
+    unsigned mask = 0;
+    for (int i = 0; i < group.members; ++i)
+    {
+      mask |= 1u << group.order[static_cast<std::size_t>(i)];
+    }
+    available = mask;
+    counting = true;
+  }
+#endif
+  return counting;
+}
+
+bool PerfCounters::enabled()
+{
+  return counting.load(std::memory_order_relaxed);
+}
+
+/**
+ *   @brief   Looks up a phase
+ *   @details Phases are only registered, never removed, so their ids
+ *            stay valid for the life of the program.
+ *   @return  The phase's id, or -1 if there's no room for it.
+ */
+int PerfCounters::phase(const std::string& name)
+{
+  std::lock_guard<std::mutex> lock(phase_mutex);
+
+  int count = phase_count.load(std::memory_order_relaxed);
+  for (int i = 0; i < count; ++i)
+  {
+    if (phase_names[static_cast<std::size_t>(i)] == name)
+    {
+      return i;
+    }
+  }
+
+  if (count == MAX_PHASES)
+  {
+    return -1;
+  }
+
+  phase_names[static_cast<std::size_t>(count)] = name;
+  phase_count.store(count + 1, std::memory_order_release);
+  return count;
+}
+
+/**
+ *   @brief   Reads the calling thread's counters
+ *   @details The whole group is read in one call. If the kernel had
+ *            more counters in use than the core has, the group was
+ *            only counting part of the time, so the totals are scaled
+ *            up to estimate the whole.
+ *   @return  True if the counters were read.
+ */
+bool PerfCounters::read(Values& values)
+{
+#ifdef __linux__
+  ThreadGroup& group = threadGroup();
+  if (!group.open())
+  {
+    return false;
+  }
+
+  // the number of counters and the time enabled and running come first
+  std::array<std::uint64_t, 3 + COUNTER_COUNT> buffer{};
+  if (::read(group.fds[0], buffer.data(), sizeof(buffer)) <= 0)
+  {
+    return false;
+  }
+
+  double scale = buffer[2] > 0 ? double(buffer[1]) / double(buffer[2]) : 0;
+  values.fill(0);
+  for (int i = 0; i < group.members; ++i)
+  {
+    auto member = static_cast<std::size_t>(i);
+    auto counter = static_cast<std::size_t>(group.order[member]);
+    values[counter] =
+      static_cast<std::uint64_t>(double(buffer[3 + member]) * scale);
+  }
+  return true;
+#else
+  (void)values;
+  return false;
+#endif
+}
+
+/**
+ *   @brief   Adds counts to a phase
+ *   @return  void
+ */
+void PerfCounters::add(int phase, const Values& counts, std::size_t entities)
+{
+  if (phase < 0)
+  {
+    return;
+  }
+
+  PhaseTotals& total = totals[static_cast<std::size_t>(phase)];
+  total.runs.fetch_add(1, std::memory_order_relaxed);
+  total.entities.fetch_add(entities, std::memory_order_relaxed);
+  for (std::size_t i = 0; i < counts.size(); ++i)
+  {
+    total.counts[i].fetch_add(counts[i], std::memory_order_relaxed);
+  }
+}
+
+/**
+ *   @brief   Gets the totals of every phase
+ *   @details Phases that were registered but never counted are left
+ *            out.
+ *   @return  The totals of each phase.
+ */
+std::vector<CounterStats> PerfCounters::summary()
+{
+  std::vector<CounterStats> summary;
+  unsigned mask = available.load(std::memory_order_relaxed);
+
+  auto total = [mask](const PhaseTotals& phase, Counter counter) {
+    return mask & (1u << counter)
+             ? double(phase.counts[counter].load(std::memory_order_relaxed))
+             : -1.0;
+  };
+
+  std::lock_guard<std::mutex> lock(phase_mutex);
+  int count = phase_count.load(std::memory_order_relaxed);
+  for (int i = 0; i < count; ++i)
+  {
+    const PhaseTotals& phase = totals[static_cast<std::size_t>(i)];
+    if (phase.runs.load(std::memory_order_relaxed) == 0)
+    {
+      continue;
+    }
+
+    CounterStats stats;
+    stats.name = phase_names[static_cast<std::size_t>(i)];
+    stats.runs = phase.runs.load(std::memory_order_relaxed);
+    stats.entities = phase.entities.load(std::memory_order_relaxed);
+    stats.cycles = total(phase, CYCLES);
+    stats.instructions = total(phase, INSTRUCTIONS);
+    stats.l1_misses = total(phase, L1_MISSES);
+    stats.llc_misses = total(phase, LLC_MISSES);
+    stats.branch_misses = total(phase, BRANCH_MISSES);
+    summary.push_back(stats);
+  }
+
+  return summary;
+}
@@ -0,0 +1,158 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ *  Hardware counter totals of a single phase of the frame.
+ *  Counters the hardware or kernel doesn't offer are reported as -1.
+ */
+struct CounterStats
+{
+  std::string name;
+  std::uint64_t runs = 0;     /**< Times the phase was counted. */
+  std::uint64_t entities = 0; /**< Objects processed over every run. */
+  double cycles = -1;
+  double instructions = -1;
+  double l1_misses = -1;  /**< Level 1 data cache read misses. */
+  double llc_misses = -1; /**< Last level cache read misses. */
+  double branch_misses = -1;
+
+  /**
+   *  Gets the instructions retired per cycle.
+   *  @return the IPC, or -1 if either counter is unavailable
+   */
+  double ipc() const;
+
+  /**
+   *  Spreads a total over every entity processed.
+   *  @param [in] total One of the counter totals
+   *  @return the total per entity, or -1 if it is unavailable
+   */
+  double perEntity(double total) const;
+};
+
+/**
+ *  Counts cycles, instructions, cache misses and branch mispredicts per
+ *  phase of the frame with the CPU's performance counters.
+ *  Each thread opens its own group of counters through perf_event_open
+ *  the first time it counts a phase. A group is read as a whole with a
+ *  single call on entering and leaving a scope, and the difference is
+ *  added to the phase. Only the thread running the scope is counted, so
+ *  work it hands to other threads must be counted by scopes of its own.
+ *
+ *  Counting is off until enabled, and stays off if the kernel refuses
+ *  to open the counters, such as in most virtual machines and
+ *  containers. The scopes are only compiled in when ENABLE_PROFILER is
+ *  defined.
+ */
+class PerfCounters
+{
+ public:
+  static constexpr int MAX_PHASES = 16;
+
+  enum Counter
+  {
+    CYCLES = 0,
+    INSTRUCTIONS,
+    L1_MISSES,
+    LLC_MISSES,
+    BRANCH_MISSES,
+    COUNTER_COUNT
+  };
+
+  using Values = std::array<std::uint64_t, COUNTER_COUNT>;
+
+  /**
+   *  Starts counting, if the counters can be opened.
+   *  @return true if counting is enabled
+   */
+  static bool enable();
+
+  /**
+   *  Is counting enabled?
+   *  @return true once enable has succeeded
+   */
+  static bool enabled();
+
+  /**
+   *  Looks up a phase, registering it on first use.
+   *  @param [in] name The phase's name
+   *  @return the phase's id, or -1 once MAX_PHASES are registered
+   */
+  static int phase(const std::string& name);
+
+  /**
+   *  Reads the calling thread's counters.
+   *  @param [out] values The running totals, scaled for any time the
+   *               group spent switched out
+   *  @return false if the thread's counters couldn't be read
+   */
+  static bool read(Values& values);
+
+  /**
+   *  Adds counts to a phase.
+   *  @param [in] phase The phase's id
+   *  @param [in] counts What the phase used
+   *  @param [in] entities The objects it processed
+   */
+  static void add(int phase, const Values& counts, std::size_t entities);
+
+  /**
+   *  Gets the totals of every phase counted so far.
+   *  @return the totals, in the order the phases were registered
+   */
+  static std::vector<CounterStats> summary();
+};
+
+/**
+ *  Counts the scope it is declared in as a phase.
+ */
+class CounterScope
+{
+ public:
+  CounterScope(int phase_, std::size_t entities_) :
+    phase(phase_),
+    entities(entities_),
+    counting(PerfCounters::enabled() && PerfCounters::read(start))
+  {
+  }
+
+  ~CounterScope()
+  {
+    PerfCounters::Values end;
+    if (counting && PerfCounters::read(end))
+    {
+      for (std::size_t i = 0; i < end.size(); ++i)
+      {
+        end[i] -= start[i];
+      }
+      PerfCounters::add(phase, end, entities);
+    }
+  }
+
+  CounterScope(const CounterScope&) = delete;
+  CounterScope& operator=(const CounterScope&) = delete;
+
+ private:
+  int phase;
+  std::size_t entities;
+  PerfCounters::Values start{};
+  bool counting;
+};
+
+#define PERF_JOIN_(a, b) a##b
+#define PERF_JOIN(a, b) PERF_JOIN_(a, b)
+
+#ifdef ENABLE_PROFILER
+/** Counts the rest of the enclosing scope as the named phase. */
+#  define PERF_COUNT_SCOPE(name, entities)                                     \
+    static const int PERF_JOIN(perf_phase_, __LINE__) =                        \
+      PerfCounters::phase(name);                                               \
+    CounterScope PERF_JOIN(perf_scope_, __LINE__)(                             \
+      PERF_JOIN(perf_phase_, __LINE__), entities)
+#else
+#  define PERF_COUNT_SCOPE(name, entities)
+#endif
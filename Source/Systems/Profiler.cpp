@@ -0,0 +1,402 @@
+#include "Profiler.h"
+#include "AsyncLogger.h"
+#include "ThreadRegistry.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <limits>
+#include <mutex>
+
+namespace
+{
+  /**
+   *  One thread's timings for a frame. Only the owning thread writes
+   *  them, so relaxed atomics are enough to let others read them.
+   */
+  struct FrameSlot
+  {
+    std::atomic<std::uint64_t> frame{ 0 };
+    std::array<std::atomic<float>, Profiler::MAX_PHASES> ms{};
+  };
+
+  /**
+   *  A span or moment captured in a trace.
+   */
+  struct TraceEvent
+  {
+    int phase = -1;
+    bool instant = false;
+    Profiler::clock::time_point start;
+    Profiler::clock::time_point end;
+  };
+
+  struct ThreadRing
+  {
+    std::array<FrameSlot, Profiler::FRAMES> slots;
+
+    // only contended while a finished trace is being written
+    std::mutex trace_mutex;
+    std::vector<TraceEvent> trace;
+    std::string name;
+  };
+
+  std::mutex phase_mutex;
+  std::array<std::string, Profiler::MAX_PHASES> phase_names;
+  std::atomic<int> phase_count{ 0 };
+
+  // a ring's last frames can still be summarised after its thread exits
+  ThreadRegistry<ThreadRing, Profiler::MAX_THREADS> rings;
+
+  // frame zero is never recorded, so empty slots never match a frame
+  std::atomic<std::uint64_t> current_frame{ 1 };
+
+  std::mutex trace_state_mutex;
+  std::atomic<bool> trace_active{ false };
+  std::uint64_t trace_frames_left = 0;
+  std::string trace_path;
+
+  void addTraceEvent(const TraceEvent& event)
+  {
+    ThreadRing* ring = rings.local();
+    if (ring != nullptr && trace_active.load(std::memory_order_relaxed))
+    {
+      std::lock_guard<std::mutex> lock(ring->trace_mutex);
+      ring->trace.push_back(event);
+    }
+  }
+
+  /**
+   *  Hands back the rings of exited threads once their last frames have
+   *  left every summary. Any trace events in them are already written.
+   */
+  void recycleRings(std::uint64_t frame)
+  {
+    rings.forEach([frame](ThreadRing& ring, bool retired) {
+      if (!retired)
+      {
+        return;
+      }
+
+      for (const FrameSlot& slot : ring.slots)
+      {
+        if (slot.frame.load(std::memory_order_relaxed) + Profiler::FRAMES >
+            frame)
+        {
+          return;
+        }
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(ring.trace_mutex);
+        ring.name.clear();
+        ring.trace.clear();
+      }
+      rings.recycle(ring);
+    });
+  }
+
+  double toMicroseconds(Profiler::clock::time_point time)
+  {
+    return std::chrono::duration<double, std::micro>(time.time_since_epoch())
+      .count();
+  }
+
+  /**
+   *  Writes every thread's captured events as Chrome trace-event JSON.
+   *  Must be called with the trace state locked and capture stopped.
+   */
+  void writeTrace()
+  {
+    std::ofstream file(trace_path);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    file.setf(std::ios::fixed);
+    file.precision(3);
+
+    std::array<std::string, Profiler::MAX_PHASES> phases;
+    {
+      std::lock_guard<std::mutex> lock(phase_mutex);
+      phases = phase_names;
+    }
+
+    std::size_t events = 0;
+    rings.forEach([&](ThreadRing& ring, bool) {
+      int id = rings.id(ring);
+      std::lock_guard<std::mutex> lock(ring.trace_mutex);
+      std::string name =
+        ring.name.empty() ? "thread " + std::to_string(id) : ring.name;
+      file << (events++ ? ",\n" : "")
+           << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+           << id << ",\"args\":{\"name\":\"" << name << "\"}}";
+
+      for (const TraceEvent& event : ring.trace)
+      {
+        auto phase = static_cast<std::size_t>(event.phase);
+        file << ",\n{\"name\":\"" << phases[phase] << "\",\"pid\":1,\"tid\":"
+             << id << ",\"ts\":" << toMicroseconds(event.start);
+        if (event.instant)
+        {
+          file << ",\"ph\":\"i\",\"s\":\"t\"}";
+        }
+        else
+        {
+          file << ",\"ph\":\"X\",\"dur\":"
+               << toMicroseconds(event.end) - toMicroseconds(event.start)
+               << "}";
+        }
+        ++events;
+      }
+
+      ring.trace.clear();
+      ring.trace.shrink_to_fit();
+    });
+
+    file << "\n]}\n";
+    // the path can change before the record is written, so isn't logged
+    AsyncLogger::log("Wrote {} trace events", events);
+  }
+}
+
+/**
+ *   @brief   Looks up a phase
+ *   @details Phases are only registered, never removed, so their ids
+ *            stay valid for the life of the program.
+ *   @return  The phase's id, or -1 if there's no room for it.
+ */
+int Profiler::phase(const std::string& name)
+{
+  std::lock_guard<std::mutex> lock(phase_mutex);
+
+  int count = phase_count.load(std::memory_order_relaxed);
+  for (int i = 0; i < count; ++i)
+  {
+    if (phase_names[static_cast<std::size_t>(i)] == name)
+    {
+      return i;
+    }
+  }
+
+  if (count == MAX_PHASES)
+  {
+    return -1;
+  }
+
+  phase_names[static_cast<std::size_t>(count)] = name;
+  phase_count.store(count + 1, std::memory_order_release);
+  return count;
+}
+
+/**
+ *   @brief   Starts a new frame
+ *   @details Rings left by exited threads are recycled here, except
+ *            while a trace still needs their events.
+ *   @return  void
+ */
+void Profiler::beginFrame()
+{
+  std::uint64_t frame =
+    current_frame.fetch_add(1, std::memory_order_relaxed) + 1;
+
+  if (!trace_active.load(std::memory_order_relaxed))
+  {
+    recycleRings(frame);
+  }
+  else
+  {
+    static const int frame_phase = phase("frame");
+    instant(frame_phase, clock::now());
+
+    std::lock_guard<std::mutex> lock(trace_state_mutex);
+    if (trace_active && --trace_frames_left == 0)
+    {
+      trace_active = false;
+      writeTrace();
+    }
+  }
+}
+
+/**
+ *   @brief   Names the calling thread in traces.
+ *   @return  void
+ */
+void Profiler::nameThread(const std::string& name)
+{
+  ThreadRing* ring = rings.local();
+  if (ring != nullptr)
+  {
+    std::lock_guard<std::mutex> lock(ring->trace_mutex);
+    ring->name = name;
+  }
+}
+
+/**
+ *   @brief   Adds time to a phase
+ *   @details A slot still holding an older frame is cleared before
+ *            its first use in this one.
+ *   @return  void
+ */
+void Profiler::record(int phase,
+                      clock::time_point start,
+                      clock::time_point end)
+{
+  ThreadRing* ring = rings.local();
+  if (ring == nullptr || phase < 0)
+  {
+    return;
+  }
+
+  std::uint64_t frame = current_frame.load(std::memory_order_relaxed);
+  FrameSlot& slot = ring->slots[frame % FRAMES];
+
+  if (slot.frame.load(std::memory_order_relaxed) != frame)
+  {
+    for (auto& ms : slot.ms)
+    {
+      ms.store(0, std::memory_order_relaxed);
+    }
+    slot.frame.store(frame, std::memory_order_relaxed);
+  }
+
+  auto& ms = slot.ms[static_cast<std::size_t>(phase)];
+  float added = std::chrono::duration<float, std::milli>(end - start).count();
+  ms.store(ms.load(std::memory_order_relaxed) + added,
+           std::memory_order_relaxed);
+
+  if (trace_active.load(std::memory_order_relaxed))
+  {
+    TraceEvent event;
+    event.phase = phase;
+    event.start = start;
+    event.end = end;
+    addTraceEvent(event);
+  }
+}
+
+/**
+ *   @brief   Marks a moment in the trace
+ *   @details Moments are only kept while a trace is being captured.
+ *   @return  void
+ */
+void Profiler::instant(int phase, clock::time_point at)
+{
+  if (phase >= 0 && trace_active.load(std::memory_order_relaxed))
+  {
+    TraceEvent event;
+    event.phase = phase;
+    event.instant = true;
+    event.start = at;
+    event.end = at;
+    addTraceEvent(event);
+  }
+}
+
+/**
+ *   @brief   Starts capturing a trace
+ *   @details Events are collected by each thread as they happen and
+ *            only written out once every frame has been captured.
+ *   @return  False if a trace is already being captured.
+ */
+bool Profiler::startTrace(std::uint64_t frames, const std::string& path)
+{
+  std::lock_guard<std::mutex> lock(trace_state_mutex);
+  if (trace_active || frames == 0)
+  {
+    return false;
+  }
+
+  // drops anything recorded as the last trace was being written
+  rings.forEach([](ThreadRing& ring, bool) {
+    std::lock_guard<std::mutex> ring_lock(ring.trace_mutex);
+    ring.trace.clear();
+  });
+
+  trace_frames_left = frames;
+  trace_path = path;
+  trace_active = true;
+  return true;
+}
+
+/**
+ *   @brief   Writes out any trace still being captured
+ *   @details Used at exit, so a trace cut short isn't lost.
+ *   @return  void
+ */
+void Profiler::stopTrace()
+{
+  std::lock_guard<std::mutex> lock(trace_state_mutex);
+  if (trace_active)
+  {
+    trace_active = false;
+    writeTrace();
+  }
+}
+
+/**
+ *   @brief   Summarises every phase
+ *   @details Each frame's time for a phase is summed over every
+ *            thread's ring. Frames where a phase didn't run are left
+ *            out of its stats. Slots are read while their owners may
+ *            be reusing them, so a frame on the edge of the ring can
+ *            occasionally be missed.
+ *   @return  The stats of each phase.
+ */
+std::vector<PhaseStats> Profiler::summary()
+{
+  int phases = phase_count.load(std::memory_order_acquire);
+  std::uint64_t frame = current_frame.load(std::memory_order_relaxed);
+
+  std::vector<PhaseStats> stats(static_cast<std::size_t>(phases));
+  {
+    std::lock_guard<std::mutex> lock(phase_mutex);
+    for (std::size_t i = 0; i < stats.size(); ++i)
+    {
+      stats[i].name = phase_names[i];
+      stats[i].min_ms = std::numeric_limits<double>::max();
+    }
+  }
+
+  std::uint64_t first = frame > FRAMES ? frame - FRAMES + 1 : 1;
+  for (std::uint64_t f = first; f < frame; ++f)
+  {
+    std::array<double, MAX_PHASES> totals{};
+    rings.forEach([&](const ThreadRing& ring, bool) {
+      const FrameSlot& slot = ring.slots[f % FRAMES];
+      if (slot.frame.load(std::memory_order_relaxed) != f)
+      {
+        return;
+      }
+
+      for (int p = 0; p < phases; ++p)
+      {
+        totals[static_cast<std::size_t>(p)] +=
+          slot.ms[static_cast<std::size_t>(p)].load(std::memory_order_relaxed);
+      }
+    });
+
+    for (std::size_t p = 0; p < stats.size(); ++p)
+    {
+      if (totals[p] > 0)
+      {
+        PhaseStats& phase = stats[p];
+        phase.frames++;
+        phase.min_ms = std::min(phase.min_ms, totals[p]);
+        phase.max_ms = std::max(phase.max_ms, totals[p]);
+        phase.avg_ms += totals[p];
+      }
+    }
+  }
+
+  for (PhaseStats& phase : stats)
+  {
+    if (phase.frames > 0)
+    {
+      phase.avg_ms /= double(phase.frames);
+    }
+    else
+    {
+      phase.min_ms = 0;
+    }
+  }
+
+  return stats;
+}
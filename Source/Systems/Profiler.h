@@ -0,0 +1,154 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ *  Rolling timings of a single phase of the frame.
+ *  Times are summed across every thread that ran the phase that frame.
+ */
+struct PhaseStats
+{
+  std::string name;
+  std::size_t frames = 0; /**< Frames the phase ran in. */
+  double min_ms = 0;
+  double avg_ms = 0;
+  double max_ms = 0;
+};
+
+/**
+ *  Times the phases of each frame.
+ *  Phases are timed by scopes, which may nest, and each thread adds its
+ *  times to its own ring of the last FRAMES frames, so timing never
+ *  takes a lock or shares a cache line with another thread. Summaries
+ *  are built from every thread's ring on request. The scopes are only
+ *  compiled in when ENABLE_PROFILER is defined.
+ *
+ *  A trace of every timed phase can also be captured for a number of
+ *  frames and written as Chrome trace-event JSON, for chrome://tracing
+ *  or Perfetto. Timestamps come from the steady clock used for the
+ *  game's own frame times.
+ */
+class Profiler
+{
+ public:
+  using clock = std::chrono::steady_clock;
+
+  static constexpr int MAX_PHASES = 32;
+  static constexpr int MAX_THREADS = 32;
+  static constexpr std::uint64_t FRAMES = 120;
+
+  /**
+   *  Looks up a phase, registering it on first use.
+   *  @param [in] name The phase's name
+   *  @return the phase's id, or -1 once MAX_PHASES are registered
+   */
+  static int phase(const std::string& name);
+
+  /**
+   *  Starts a new frame.
+   *  Called once per frame by the thread that drives the game loop.
+   */
+  static void beginFrame();
+
+  /**
+   *  Names the calling thread in traces.
+   *  @param [in] name The thread's name
+   */
+  static void nameThread(const std::string& name);
+
+  /**
+   *  Adds time to a phase in the current frame.
+   *  Ignored while MAX_THREADS other threads are recording.
+   *  @param [in] phase The phase's id
+   *  @param [in] start When the phase started
+   *  @param [in] end When the phase ended
+   */
+  static void record(int phase, clock::time_point start, clock::time_point end);
+
+  /**
+   *  Marks a moment in the trace, such as an input event.
+   *  @param [in] phase The phase's id
+   *  @param [in] at When it happened
+   */
+  static void instant(int phase, clock::time_point at);
+
+  /**
+   *  Starts capturing a trace.
+   *  @param [in] frames The number of frames to capture
+   *  @param [in] path Where the trace is written once captured
+   *  @return false if a trace is already being captured
+   */
+  static bool startTrace(std::uint64_t frames, const std::string& path);
+
+  /**
+   *  Writes out any trace still being captured.
+   */
+  static void stopTrace();
+
+  /**
+   *  Summarises every phase over the frames still in the rings.
+   *  The frame in progress is left out.
+   *  @return the stats of each phase, in the order they were registered
+   */
+  static std::vector<PhaseStats> summary();
+};
+
+/**
+ *  Times the scope it is declared in as a phase.
+ */
+class ProfileScope
+{
+ public:
+  explicit ProfileScope(int phase_) :
+    phase(phase_), start(Profiler::clock::now())
+  {
+  }
+
+  ~ProfileScope() { Profiler::record(phase, start, Profiler::clock::now()); }
+
+  ProfileScope(const ProfileScope&) = delete;
+  ProfileScope& operator=(const ProfileScope&) = delete;
+
+ private:
+  int phase;
+  Profiler::clock::time_point start;
+};
+
+#define PROFILE_JOIN_(a, b) a##b
+#define PROFILE_JOIN(a, b) PROFILE_JOIN_(a, b)
+
+#ifdef ENABLE_PROFILER
+/** Times the rest of the enclosing scope as the named phase. */
+#  define PROFILE_SCOPE(name)                                                  \
+    static const int PROFILE_JOIN(profile_phase_, __LINE__) =                  \
+      Profiler::phase(name);                                                   \
+    ProfileScope PROFILE_JOIN(profile_scope_, __LINE__)(                       \
+      PROFILE_JOIN(profile_phase_, __LINE__))
+
+/** Times the rest of the enclosing scope as an already registered phase. */
+#  define PROFILE_PHASE(id)                                                    \
+    ProfileScope PROFILE_JOIN(profile_scope_, __LINE__)(id)
+
+/** Times a span that didn't happen within a single scope. */
+#  define PROFILE_SPAN(name, start, end)                                       \
+    do                                                                         \
+    {                                                                          \
+      static const int profile_phase = Profiler::phase(name);                  \
+      Profiler::record(profile_phase, start, end);                             \
+    } while (false)
+
+/** Marks a moment in the trace. */
+#  define PROFILE_INSTANT(name, at)                                            \
+    do                                                                         \
+    {                                                                          \
+      static const int profile_phase = Profiler::phase(name);                  \
+      Profiler::instant(profile_phase, at);                                    \
+    } while (false)
+#else
+#  define PROFILE_SCOPE(name)
+#  define PROFILE_PHASE(id)
+#  define PROFILE_SPAN(name, start, end)
+#  define PROFILE_INSTANT(name, at)
+#endif
@@ -0,0 +1,114 @@
+#include "RenderList.h"
+#include <algorithm>
+
+/**
+ *   @brief   Constructor.
+ *   @details Requires the job system used to run the build jobs.
+ *   @return  void
+ */
+RenderList::RenderList(JobSystem& job_system) : jobs(job_system) {}
+
+/**
+ *   @brief   Builds the draw list.
+ *   @details Each job is handed its own buffer to fill, so the jobs
+ *            never contend with one another. Once filled, each buffer
+ *            is sorted on the thread that built it before the results
+ *            are merged on the calling thread.
+ *   @return  void
+ */
+void RenderList::build(std::size_t job_count, const Job& job)
+{
+  if (buffers.size() < job_count)
+  {
+    buffers.resize(job_count);
+  }
+
+  jobs.parallelFor(0, job_count, 1, [&](std::size_t b, std::size_t e) {
+    for (std::size_t index = b; index < e; ++index)
+    {
+      auto& buffer = buffers[index];
+      buffer.clear();
+      job(index, buffer);
+
+      std::sort(buffer.begin(),
+                buffer.end(),
+                [](const RenderItem& lhs, const RenderItem& rhs) {
+                  return lhs.sort_key < rhs.sort_key;
+                });
+    }
+  });
+
+  for (std::size_t i = job_count; i < buffers.size(); ++i)
+  {
+    buffers[i].clear();
+  }
+
+  merge();
+}
+
+/**
+ *   @brief   Gets the draw list.
+ *   @return  Every item built this frame, in sort key order.
+ */
+const std::vector<RenderItem>& RenderList::items() const
+{
+  return merged;
+}
+
+/**
+ *   @brief   Creates a sort key.
+ *   @details Items are drawn layer by layer, and from the top of the
+ *            screen to the bottom within each layer.
+ *   @return  The key used to order the item.
+ */
+std::uint64_t RenderList::sortKey(std::uint8_t layer, float depth)
+{
+  // bias the depth so items partially above the screen stay in order
+  float biased = std::max(0.f, depth + 65536.f);
+  return static_cast<std::uint64_t>(layer) << 32 |
+         static_cast<std::uint32_t>(biased);
+}
+
+/**
+ *   @brief   Merges the sorted buffers.
+ *   @details A k-way merge using a min-heap of the head of each
+ *            buffer, which is cheaper than re-sorting everything.
+ *   @return  void
+ */
+void RenderList::merge()
+{
+  auto later = [](const Head& lhs, const Head& rhs) { return lhs > rhs; };
+
+  heads.clear();
+  cursors.assign(buffers.size(), 0);
+
+  std::size_t total = 0;
+  for (std::size_t i = 0; i < buffers.size(); ++i)
+  {
+    total += buffers[i].size();
+    if (!buffers[i].empty())
+    {
+      heads.emplace_back(buffers[i].front().sort_key, i);
+    }
+  }
+  std::make_heap(heads.begin(), heads.end(), later);
+
+  merged.clear();
+  merged.reserve(total);
+
+  while (!heads.empty())
+  {
+    std::pop_heap(heads.begin(), heads.end(), later);
+    std::size_t buffer = heads.back().second;
+    heads.pop_back();
+
+    auto& cursor = cursors[buffer];
+    merged.push_back(buffers[buffer][cursor++]);
+
+    if (cursor < buffers[buffer].size())
+    {
+      heads.emplace_back(buffers[buffer][cursor].sort_key, buffer);
+      std::push_heap(heads.begin(), heads.end(), later);
+    }
+  }
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "JobSystem.h"
+
+/**
+ *  A single sprite queued for drawing.
+ *  The position has already been transformed into screen space. Items
+ *  name their texture rather than point at a live sprite, so a list can
+ *  be drawn whilst the next frame is being simulated.
+ */
+struct RenderItem
+{
+  std::uint64_t sort_key = 0;
+  std::uint8_t texture = 0;
+  float x = 0;
+  float y = 0;
+  float width = 0;
+  float height = 0;
+  int frame = -1; /**< Atlas frame to draw, or -1 for the whole texture. */
+};
+
+/**
+ *  Builds the frame's draw list across several threads.
+ *  The scene is split into jobs, each of which filters, culls and
+ *  transforms its share of the entities into its own buffer. Buffers are
+ *  sorted independently and then k-way merged by sort key, ready for the
+ *  main thread to submit to the renderer. Buffers keep their capacity
+ *  between frames so building the list doesn't allocate.
+ */
+class RenderList
+{
+ public:
+  using Job = std::function<void(std::size_t, std::vector<RenderItem>&)>;
+
+  /**
+   *  Constructor.
+   *  @param [in] job_system The jobs used to build the list
+   */
+  explicit RenderList(JobSystem& job_system);
+
+  void build(std::size_t job_count, const Job& job);
+  const std::vector<RenderItem>& items() const;
+
+  static std::uint64_t sortKey(std::uint8_t layer, float depth);
+
+ private:
+  using Head = std::pair<std::uint64_t, std::size_t>;
+  void merge();
+
+  JobSystem& jobs;
+  std::vector<std::vector<RenderItem>> buffers;
+  std::vector<RenderItem> merged;
+  std::vector<Head> heads;
+  std::vector<std::size_t> cursors;
+};
@@ -0,0 +1,470 @@
+#include "SamplingProfiler.h"
+#include <iostream>
+
+#ifdef __linux__
+#  include <algorithm>
+#  include <array>
+#  include <atomic>
+#  include <cerrno>
+#  include <csignal>
+#  include <cstdint>
+#  include <cstring>
+#  include <ctime>
+#  include <cxxabi.h>
+#  include <dlfcn.h>
+#  include <elf.h>
+#  include <fstream>
+#  include <iterator>
+#  include <link.h>
+#  include <map>
+#  include <memory>
+#  include <mutex>
+#  include <pthread.h>
+#  include <sys/syscall.h>
+#  include <ucontext.h>
+#  include <unistd.h>
+#  include <vector>
+
+#  ifndef sigev_notify_thread_id
+#    define sigev_notify_thread_id _sigev_un._tid
+#  endif
+
+namespace
+{
+  struct Sample
+  {
+    std::atomic<int> depth{ 0 }; /**< Set last, once the stack is in. */
+    std::array<void*, SamplingProfiler::MAX_DEPTH> frames;
+  };
+
+  std::atomic<bool> sampling{ false };
+  std::unique_ptr<Sample[]> samples;
+  std::atomic<std::size_t> next_sample{ 0 };
+  std::atomic<std::size_t> dropped{ 0 };
+  long interval_ns = 0;
+
+  std::mutex timer_mutex;
+  std::vector<timer_t> timers;
+
+  /**
+   *  Deletes the thread's timer when the thread exits.
+   */
+  struct ThreadTimer
+  {
+    timer_t timer{};
+    bool armed = false;
+    std::uintptr_t stack_low = 0; /**< The thread's stack, for the walk. */
+    std::uintptr_t stack_high = 0;
+
+    ~ThreadTimer()
+    {
+      std::lock_guard<std::mutex> lock(timer_mutex);
+      auto found = std::find(timers.begin(), timers.end(), timer);
+      if (armed && found != timers.end())
+      {
+        timer_delete(timer);
+        timers.erase(found);
+      }
+    }
+  };
+
+  thread_local ThreadTimer thread_timer;
+
+  /**
+   *  Follows the frame pointers from the interrupted instruction.
+   *  Only plain loads are used, so unlike backtrace it's safe in a
+   *  signal handler. The chain is only followed while it climbs the
+   *  thread's own stack, so a function built without frame pointers
+   *  ends the walk early rather than faulting.
+   */
+  int walkStack(const ucontext_t& context, Sample& sample)
+  {
+#  if defined(__x86_64__)
+    auto pc = static_cast<std::uintptr_t>(context.uc_mcontext.gregs[REG_RIP]);
+    auto frame =
+      static_cast<std::uintptr_t>(context.uc_mcontext.gregs[REG_RBP]);
+#  elif defined(__aarch64__)
+    auto pc = static_cast<std::uintptr_t>(context.uc_mcontext.pc);
+    auto frame = static_cast<std::uintptr_t>(context.uc_mcontext.regs[29]);
+#  else
+    std::uintptr_t pc = 0;
+    std::uintptr_t frame = 0;
+#  endif
+
+    if (pc == 0)
+    {
+      return 0;
+    }
+
+    sample.frames[0] = reinterpret_cast<void*>(pc);
+    int depth = 1;
+
+    // each frame holds the caller's frame, then the return address
+    while (depth < SamplingProfiler::MAX_DEPTH &&
+           frame >= thread_timer.stack_low &&
+           frame + 2 * sizeof(void*) <= thread_timer.stack_high &&
+           frame % alignof(void*) == 0)
+    {
+      const auto* link = reinterpret_cast<const std::uintptr_t*>(frame);
+      if (link[1] == 0)
+      {
+        break;
+      }
+
+      sample.frames[static_cast<std::size_t>(depth++)] =
+        reinterpret_cast<void*>(link[1]);
+      if (link[0] <= frame)
+      {
+        break;
+      }
+      frame = link[0];
+    }
+
+    return depth;
+  }
+
+  void onSample(int, siginfo_t*, void* context)
+  {
+    if (!sampling.load(std::memory_order_relaxed))
+    {
+      return;
+    }
+
+    int saved_errno = errno;
+    std::size_t index = next_sample.fetch_add(1, std::memory_order_relaxed);
+
+    if (index < SamplingProfiler::MAX_SAMPLES)
+    {
+      Sample& sample = samples[index];
+      int depth = walkStack(*static_cast<ucontext_t*>(context), sample);
+      sample.depth.store(depth, std::memory_order_release);
+    }
+    else
+    {
+      dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    errno = saved_errno;
+  }
+
+  /**
+   *  The executable's function symbols, sorted by address.
+   */
+  class SymbolTable
+  {
+   public:
+    void load()
+    {
+      std::ifstream file("/proc/self/exe", std::ios::binary);
+      image.assign(std::istreambuf_iterator<char>(file),
+                   std::istreambuf_iterator<char>());
+
+      if (image.size() < sizeof(Elf64_Ehdr) ||
+          std::memcmp(image.data(), ELFMAG, SELFMAG) != 0 ||
+          image[EI_CLASS] != ELFCLASS64)
+      {
+        return;
+      }
+
+      // position independent executables are loaded at an offset
+      dl_iterate_phdr(
+        [](dl_phdr_info* info, std::size_t, void* data) {
+          *static_cast<std::uintptr_t*>(data) = info->dlpi_addr;
+          return 1;
+        },
+        &bias);
+
+      Elf64_Ehdr header;
+      std::memcpy(&header, image.data(), sizeof(header));
+
+      for (int pass = 0; pass < 2 && functions.empty(); ++pass)
+      {
+        // the full symbol table, or failing that the dynamic one
+        std::uint32_t wanted = pass == 0 ? SHT_SYMTAB : SHT_DYNSYM;
+        for (std::size_t i = 0; i < header.e_shnum; ++i)
+        {
+          Elf64_Shdr section = sectionAt(header, i);
+          if (section.sh_type == wanted)
+          {
+            addFunctions(section, sectionAt(header, section.sh_link));
+          }
+        }
+      }
+
+      std::sort(functions.begin(), functions.end());
+    }
+
+    std::string nameOf(void* address) const
+    {
+      auto value = reinterpret_cast<std::uintptr_t>(address);
+      auto after = std::upper_bound(
+        functions.begin(), functions.end(), Function{ value, 0, 0 });
+
+      if (after != functions.begin())
+      {
+        const Function& function = *std::prev(after);
+        if (value < function.address + function.size)
+        {
+          return demangle(&image[function.name]);
+        }
+      }
+
+      // outside the executable, so try the shared libraries
+      Dl_info info;
+      if (dladdr(address, &info) != 0)
+      {
+        if (info.dli_sname != nullptr)
+        {
+          return demangle(info.dli_sname);
+        }
+        if (info.dli_fname != nullptr)
+        {
+          const char* slash = std::strrchr(info.dli_fname, '/');
+          return slash != nullptr ? slash + 1 : info.dli_fname;
+        }
+      }
+
+      return "[unknown]";
+    }
+
+   private:
+    struct Function
+    {
+      std::uintptr_t address;
+      std::uintptr_t size;
+      std::size_t name; /**< Offset of the name in the image. */
+
+      bool operator<(const Function& rhs) const
+      {
+        return address < rhs.address;
+      }
+    };
+
+    Elf64_Shdr sectionAt(const Elf64_Ehdr& header, std::size_t i) const
+    {
+      Elf64_Shdr section{};
+      std::size_t offset = header.e_shoff + i * header.e_shentsize;
+      if (offset + sizeof(section) <= image.size())
+      {
+        std::memcpy(&section, &image[offset], sizeof(section));
+      }
+      return section;
+    }
+
+    void addFunctions(const Elf64_Shdr& symbols, const Elf64_Shdr& names)
+    {
+      std::size_t count = symbols.sh_size / sizeof(Elf64_Sym);
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        std::size_t offset = symbols.sh_offset + i * sizeof(Elf64_Sym);
+        if (offset + sizeof(Elf64_Sym) > image.size())
+        {
+          break;
+        }
+
+        Elf64_Sym symbol;
+        std::memcpy(&symbol, &image[offset], sizeof(symbol));
+        std::size_t name = names.sh_offset + symbol.st_name;
+
+        if (ELF64_ST_TYPE(symbol.st_info) == STT_FUNC &&
+            symbol.st_value != 0 && symbol.st_size != 0 &&
+            name < image.size())
+        {
+          functions.push_back(
+            Function{ symbol.st_value + bias, symbol.st_size, name });
+        }
+      }
+    }
+
+    static std::string demangle(const char* name)
+    {
+      int status = 0;
+      char* readable = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+      std::string result = status == 0 ? readable : name;
+      std::free(readable);
+
+      // semicolons separate frames in folded stacks
+      std::replace(result.begin(), result.end(), ';', ':');
+      return result;
+    }
+
+    std::vector<char> image;
+    std::vector<Function> functions;
+    std::uintptr_t bias = 0;
+  };
+}
+
+/**
+ *   @brief   Starts sampling
+ *   @details Stacks are walked by following frame pointers, as
+ *            backtrace may lock or allocate and so can't be called
+ *            from a signal handler. Code built without them, as by
+ *            turning ENABLE_FRAME_POINTERS off, gives shallow stacks.
+ *   @return  True if sampling started.
+ */
+bool SamplingProfiler::start(int hz)
+{
+  if (hz <= 0 || samples)
+  {
+    return false;
+  }
+
+  samples = std::make_unique<Sample[]>(MAX_SAMPLES);
+  interval_ns = 1000000000L / hz;
+
+  struct sigaction action
+  {
+  };
+  action.sa_sigaction = onSample;
+  action.sa_flags = SA_SIGINFO | SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  if (sigaction(SIGPROF, &action, nullptr) != 0)
+  {
+    return false;
+  }
+
+  sampling = true;
+  registerThread();
+  return true;
+}
+
+/**
+ *   @brief   Starts sampling the calling thread
+ *   @details Each thread's timer counts its own CPU time and signals
+ *            only that thread, so idle threads aren't sampled. The
+ *            thread's stack is found first, as the walk must never
+ *            leave it.
+ *   @return  void
+ */
+void SamplingProfiler::registerThread()
+{
+  if (!sampling || thread_timer.armed)
+  {
+    return;
+  }
+
+  pthread_attr_t attributes;
+  if (pthread_getattr_np(pthread_self(), &attributes) != 0)
+  {
+    return;
+  }
+
+  void* stack = nullptr;
+  std::size_t stack_size = 0;
+  int found = pthread_attr_getstack(&attributes, &stack, &stack_size);
+  pthread_attr_destroy(&attributes);
+  if (found != 0)
+  {
+    return;
+  }
+
+  thread_timer.stack_low = reinterpret_cast<std::uintptr_t>(stack);
+  thread_timer.stack_high = thread_timer.stack_low + stack_size;
+
+  sigevent event{};
+  event.sigev_notify = SIGEV_THREAD_ID;
+  event.sigev_signo = SIGPROF;
+  event.sigev_notify_thread_id = static_cast<pid_t>(syscall(SYS_gettid));
+
+  timer_t timer;
+  if (timer_create(CLOCK_THREAD_CPUTIME_ID, &event, &timer) != 0)
+  {
+    return;
+  }
+
+  itimerspec period{};
+  period.it_interval.tv_nsec = interval_ns % 1000000000L;
+  period.it_interval.tv_sec = interval_ns / 1000000000L;
+  period.it_value = period.it_interval;
+  timer_settime(timer, 0, &period, nullptr);
+
+  std::lock_guard<std::mutex> lock(timer_mutex);
+  timers.push_back(timer);
+  thread_timer.timer = timer;
+  thread_timer.armed = true;
+}
+
+/**
+ *   @brief   Stops sampling and writes the folded stacks
+ *   @details Stacks are written root first. Return addresses point
+ *            after their call, so one is taken off each before it is
+ *            looked up, except for the interrupted instruction.
+ *   @return  void
+ */
+void SamplingProfiler::stop(const std::string& path)
+{
+  if (!samples)
+  {
+    return;
+  }
+
+  sampling = false;
+  {
+    std::lock_guard<std::mutex> lock(timer_mutex);
+    for (timer_t timer : timers)
+    {
+      timer_delete(timer);
+    }
+    timers.clear();
+  }
+
+  SymbolTable symbols;
+  symbols.load();
+
+  std::map<void*, std::string> names;
+  auto nameOf = [&](void* address) -> const std::string& {
+    auto found = names.find(address);
+    if (found == names.end())
+    {
+      found = names.emplace(address, symbols.nameOf(address)).first;
+    }
+    return found->second;
+  };
+
+  std::map<std::string, std::size_t> stacks;
+  std::size_t taken = std::min(next_sample.load(), MAX_SAMPLES);
+
+  for (std::size_t i = 0; i < taken; ++i)
+  {
+    const Sample& sample = samples[i];
+    int depth = sample.depth.load(std::memory_order_acquire);
+
+    std::string stack;
+    for (int frame = depth - 1; frame >= 0; --frame)
+    {
+      auto* address = static_cast<char*>(sample.frames[frame]);
+      stack += nameOf(frame == 0 ? address : address - 1);
+      stack += frame == 0 ? "" : ";";
+    }
+
+    if (!stack.empty())
+    {
+      stacks[stack]++;
+    }
+  }
+
+  std::ofstream file(path);
+  for (const auto& stack : stacks)
+  {
+    file << stack.first << ' ' << stack.second << '\n';
+  }
+
+  std::cout << "Wrote " << taken << " samples (" << dropped
+            << " dropped) as " << stacks.size() << " folded stacks to "
+            << path << std::endl;
+}
+
+#else
+
+bool SamplingProfiler::start(int)
+{
+  std::cerr << "The sampling profiler is only supported on Linux"
+            << std::endl;
+  return false;
+}
+
+void SamplingProfiler::registerThread() {}
+
+void SamplingProfiler::stop(const std::string&) {}
+
+#endif
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+/**
+ *  A statistical profiler built into the binary.
+ *  Every registered thread gets a timer that raises SIGPROF after each
+ *  slice of CPU time it uses. The signal handler walks the thread's
+ *  frame pointers into a preallocated buffer, claiming its slot with a
+ *  single atomic increment, so sampling never locks or allocates. At
+ *  exit the return addresses are resolved against the executable's own
+ *  symbol table and written as folded stacks, one line per unique stack
+ *  with its sample count, ready for flamegraph tools.
+ *
+ *  Only Linux is supported. Elsewhere starting the profiler fails.
+ *  Stacks are only complete through code built with frame pointers.
+ */
+class SamplingProfiler
+{
+ public:
+  static constexpr int MAX_DEPTH = 48;
+  static constexpr std::size_t MAX_SAMPLES = 1 << 16;
+
+  /**
+   *  Starts sampling the calling thread and any registered after it.
+   *  @param [in] hz Samples per second of CPU time, per thread
+   *  @return true if sampling started
+   */
+  static bool start(int hz);
+
+  /**
+   *  Starts sampling the calling thread, if the profiler is running.
+   *  Threads call this as they start, and stop being sampled on exit.
+   */
+  static void registerThread();
+
+  /**
+   *  Stops sampling and writes the folded stacks.
+   *  Does nothing if the profiler was never started.
+   *  @param [in] path The file to write
+   */
+  static void stop(const std::string& path);
+};
@@ -0,0 +1,239 @@
+#include "SessionTelemetry.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <utility>
+
+#ifdef __linux__
+#  include <sys/resource.h>
+#endif
+
+namespace
+{
+  // bump whenever the report's layout changes
+  constexpr int REPORT_FORMAT = 1;
+
+  std::uint64_t toUs(double ms)
+  {
+    return static_cast<std::uint64_t>(std::max(0.0, ms * 1000.0));
+  }
+
+  double toMs(std::uint64_t us)
+  {
+    return double(us) / 1000.0;
+  }
+
+  std::string buildName()
+  {
+#if defined(__clang__)
+    std::string build = "clang " __clang_version__;
+#elif defined(__GNUC__)
+    std::string build = "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    std::string build = "msvc " + std::to_string(_MSC_VER);
+#else
+    std::string build = "unknown compiler";
+#endif
+
+#ifdef NDEBUG
+    build += ", release";
+#else
+    build += ", debug";
+#endif
+
+#ifdef ENABLE_PROFILER
+    build += ", profiler on";
+#else
+    build += ", profiler off";
+#endif
+    return build;
+  }
+
+  std::string machineName()
+  {
+#if defined(__linux__)
+    std::string machine = "linux";
+#elif defined(_WIN32)
+    std::string machine = "windows";
+#elif defined(__APPLE__)
+    std::string machine = "macos";
+#else
+    std::string machine = "unknown os";
+#endif
+
+    machine += ", hardware threads " +
+               std::to_string(std::thread::hardware_concurrency());
+
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line))
+    {
+      if (line.compare(0, 10, "model name") == 0)
+      {
+        std::size_t colon = line.find(':');
+        if (colon != std::string::npos && colon + 2 <= line.size())
+        {
+          machine += ", " + line.substr(colon + 2);
+        }
+        break;
+      }
+    }
+    return machine;
+  }
+}
+
+/**
+ *   @brief   Constructor.
+ *   @details Thresholds are sorted so hitches are always listed from
+ *            the mildest up.
+ */
+SessionTelemetry::SessionTelemetry(std::vector<double> hitch_ms) :
+  hitches(std::move(hitch_ms)), session_start(clock::now())
+{
+  std::sort(hitches.begin(), hitches.end());
+}
+
+/**
+ *   @brief   Names the phases that will be recorded.
+ *   @details Every histogram is allocated here, so recording never
+ *            allocates.
+ *   @return  void
+ */
+void SessionTelemetry::setPhases(const std::vector<std::string>& names)
+{
+  phases.clear();
+  phases.reserve(names.size());
+  for (const std::string& name : names)
+  {
+    phases.push_back(Phase{ name, HdrHistogram() });
+  }
+}
+
+/**
+ *   @brief   Records a frame starting.
+ *   @return  void
+ */
+void SessionTelemetry::beginFrame(clock::time_point now)
+{
+  if (last_frame != clock::time_point{})
+  {
+    std::chrono::duration<double, std::milli> elapsed = now - last_frame;
+    frames.record(toUs(elapsed.count()));
+  }
+  last_frame = now;
+}
+
+/**
+ *   @brief   Stops timing frames until the next one begins.
+ *   @return  void
+ */
+void SessionTelemetry::pause()
+{
+  last_frame = clock::time_point{};
+}
+
+/**
+ *   @brief   Records the time a phase took.
+ *   @return  void
+ */
+void SessionTelemetry::recordPhase(std::size_t phase, double ms)
+{
+  if (phase < phases.size())
+  {
+    phases[phase].histogram.record(toUs(ms));
+  }
+}
+
+/**
+ *   @brief   Writes the session report.
+ *   @details Phases that never ran, such as when the session never
+ *            left the menu, are left out.
+ *   @return  void
+ */
+void SessionTelemetry::write(std::ostream& out, double target_fps) const
+{
+  std::chrono::duration<double> session = clock::now() - session_start;
+  char line[128];
+
+  out << "Session report (format " << REPORT_FORMAT << ")\n";
+  out << "build: " << buildName() << '\n';
+  out << "machine: " << machineName() << '\n';
+  std::snprintf(line,
+                sizeof(line),
+                "session: %.1fs, target %.0ffps\n",
+                session.count(),
+                target_fps);
+  out << line;
+
+  out << "times in ms       count      p50      p90      p99    p99.9"
+         "      max";
+  for (double hitch : hitches)
+  {
+    char label[16];
+    std::snprintf(label, sizeof(label), ">%g", hitch);
+    std::snprintf(line, sizeof(line), " %7s", label);
+    out << line;
+  }
+  out << '\n';
+
+  writeHistogram(out, "frame", frames);
+  for (const Phase& phase : phases)
+  {
+    if (phase.histogram.count() > 0)
+    {
+      writeHistogram(out, phase.name, phase.histogram);
+    }
+  }
+
+  out << "peak rss: " << peakRssKb() << "kB" << std::endl;
+}
+
+/**
+ *   @brief   Gets the peak resident memory.
+ *   @return  The peak in kilobytes.
+ */
+long SessionTelemetry::peakRssKb()
+{
+#ifdef __linux__
+  rusage usage{};
+  if (getrusage(RUSAGE_SELF, &usage) == 0)
+  {
+    return usage.ru_maxrss;
+  }
+#endif
+  return 0;
+}
+
+/**
+ *   @brief   Writes one histogram's row of the report.
+ *   @return  void
+ */
+void SessionTelemetry::writeHistogram(std::ostream& out,
+                                      const std::string& name,
+                                      const HdrHistogram& histogram) const
+{
+  char line[128];
+  std::snprintf(line,
+                sizeof(line),
+                "%-12.12s %10llu %8.2f %8.2f %8.2f %8.2f %8.2f",
+                name.c_str(),
+                static_cast<unsigned long long>(histogram.count()),
+                toMs(histogram.percentile(0.5)),
+                toMs(histogram.percentile(0.9)),
+                toMs(histogram.percentile(0.99)),
+                toMs(histogram.percentile(0.999)),
+                toMs(histogram.max()));
+  out << line;
+
+  for (double hitch : hitches)
+  {
+    std::snprintf(line,
+                  sizeof(line),
+                  " %7llu",
+                  static_cast<unsigned long long>(
+                    histogram.countAbove(toUs(hitch))));
+    out << line;
+  }
+  out << '\n';
+}
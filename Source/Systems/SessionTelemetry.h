@@ -0,0 +1,89 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "HdrHistogram.h"
+
+/**
+ *  Records how smoothly a play session ran and reports it at exit.
+ *  Frame times and the time of each phase of the frame are kept in HDR
+ *  histograms, so a session of any length uses the same memory. Frames
+ *  are recorded by the game loop and phases by the simulation, each
+ *  from a single thread, so the report should only be written once the
+ *  game has stopped.
+ *
+ *  The report lists the build and machine it came from alongside the
+ *  percentiles, the frames slower than each hitch threshold and the
+ *  peak resident memory, one line per histogram, so reports from
+ *  different builds and machines can be compared side by side.
+ */
+class SessionTelemetry
+{
+ public:
+  using clock = std::chrono::steady_clock;
+
+  /**
+   *  Constructor.
+   *  @param [in] hitch_ms Frames slower than each of these are counted
+   */
+  explicit SessionTelemetry(std::vector<double> hitch_ms = {});
+
+  /**
+   *  Names the phases that will be recorded.
+   *  @param [in] names One name per phase, in the order recorded
+   */
+  void setPhases(const std::vector<std::string>& names);
+
+  /**
+   *  Records a frame starting.
+   *  Frames are timed from the start of one to the start of the next.
+   *  @param [in] now When the frame started
+   */
+  void beginFrame(clock::time_point now);
+
+  /**
+   *  Stops timing frames until the next one begins, such as while the
+   *  game sleeps on a static screen, so the pause isn't a hitch.
+   */
+  void pause();
+
+  /**
+   *  Records the time a phase took.
+   *  @param [in] phase The phase's index in setPhases
+   *  @param [in] ms How long it took
+   */
+  void recordPhase(std::size_t phase, double ms);
+
+  /**
+   *  Writes the session report.
+   *  @param [out] out Where to write it
+   *  @param [in] target_fps The frame rate the game was paced to
+   */
+  void write(std::ostream& out, double target_fps) const;
+
+  /**
+   *  Gets the peak resident memory of the process.
+   *  @return the peak in kilobytes, or zero where it can't be measured
+   */
+  static long peakRssKb();
+
+ private:
+  struct Phase
+  {
+    std::string name;
+    HdrHistogram histogram;
+  };
+
+  void writeHistogram(std::ostream& out,
+                      const std::string& name,
+                      const HdrHistogram& histogram) const;
+
+  std::vector<double> hitches;
+  HdrHistogram frames;
+  std::vector<Phase> phases;
+  clock::time_point last_frame{};
+  clock::time_point session_start;
+};
@@ -0,0 +1,134 @@
+#include "SharedMetrics.h"
+#include <cstring>
+#include <new>
+
+#ifdef __linux__
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <unistd.h>
+#endif
+
+namespace
+{
+  // a reader that keeps losing the race gives up rather than spin
+  constexpr int READ_ATTEMPTS = 64;
+}
+
+/**
+ *   @brief   Destructor.
+ *   @details Unmaps and removes the segment, so monitors can tell
+ *            the game has gone.
+ */
+SharedMetrics::~SharedMetrics()
+{
+#ifdef __linux__
+  if (segment != nullptr)
+  {
+    munmap(segment, sizeof(MetricsSegment));
+    shm_unlink(segment_name.c_str());
+  }
+#endif
+}
+
+/**
+ *   @brief   Creates the segment
+ *   @details The header is filled in last, so a monitor that opens
+ *            the segment part way through rejects it.
+ *   @return  True if the segment was created.
+ */
+bool SharedMetrics::open(const std::string& name)
+{
+#ifdef __linux__
+  if (segment != nullptr)
+  {
+    return false;
+  }
+
+  int fd = shm_open(name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+  if (fd < 0)
+  {
+    return false;
+  }
+
+  void* memory = MAP_FAILED;
+  if (ftruncate(fd, sizeof(MetricsSegment)) == 0)
+  {
+    memory = mmap(nullptr,
+                  sizeof(MetricsSegment),
+                  PROT_READ | PROT_WRITE,
+                  MAP_SHARED,
+                  fd,
+                  0);
+  }
+  close(fd);
+
+  if (memory == MAP_FAILED)
+  {
+    shm_unlink(name.c_str());
+    return false;
+  }
+
+  segment = new (memory) MetricsSegment();
+  segment->size = sizeof(MetricsSegment);
+  segment->version = VERSION;
+  std::atomic_thread_fence(std::memory_order_release);
+  segment->magic = MAGIC;
+  segment_name = name;
+  return true;
+#else
+  (void)name;
+  return false;
+#endif
+}
+
+/**
+ *   @brief   Copies a frame into the segment
+ *   @details The sequence is made odd before the frame is written
+ *            and even again afterwards. The fences keep the frame's
+ *            writes between the two.
+ *   @return  void
+ */
+void SharedMetrics::publish(const MetricsFrame& frame)
+{
+  if (segment == nullptr)
+  {
+    return;
+  }
+
+  std::uint32_t sequence =
+    segment->sequence.load(std::memory_order_relaxed);
+  segment->sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  std::memcpy(&segment->frame, &frame, sizeof(frame));
+
+  segment->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+/**
+ *   @brief   Copies a consistent frame out of a segment
+ *   @details The copy is only kept if the sequence was even and
+ *            unchanged on both sides of it.
+ *   @return  True if a consistent frame was read.
+ */
+bool SharedMetrics::read(const MetricsSegment& segment, MetricsFrame& frame)
+{
+  for (int attempt = 0; attempt < READ_ATTEMPTS; ++attempt)
+  {
+    std::uint32_t before = segment.sequence.load(std::memory_order_acquire);
+    if (before % 2 != 0)
+    {
+      continue;
+    }
+
+    std::memcpy(&frame, &segment.frame, sizeof(frame));
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (segment.sequence.load(std::memory_order_relaxed) == before)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/**
+ *  One frame's worth of live metrics, as laid out in shared memory.
+ *  Only fixed width fields are used so any process can map it, and
+ *  every change to the layout must bump SharedMetrics::VERSION.
+ */
+struct MetricsFrame
+{
+  static constexpr int MAX_PHASES = 16;
+  static constexpr int NAME_LENGTH = 24;
+
+  struct Phase
+  {
+    char name[NAME_LENGTH]; /**< Null terminated. */
+    float ms;
+  };
+
+  std::uint64_t frame;           /**< Frames simulated since launch. */
+  float frame_ms;                /**< Time since the previous frame. */
+  float graph_ms;                /**< Wall time of the frame graph. */
+  std::uint32_t phase_count;
+  Phase phases[MAX_PHASES];      /**< Time each frame graph task took. */
+  std::uint32_t aliens_alive;
+  std::uint32_t aliens_total;
+  std::uint32_t lasers_live;
+  std::uint32_t collision_pairs; /**< Bounds tested this frame. */
+  std::uint64_t allocations;     /**< Heap allocations since launch. */
+  std::uint32_t frame_allocations;
+  std::int32_t score;
+  std::uint8_t in_menu;
+  std::uint8_t movement; /**< Choosing the alien movement mode. */
+  std::uint8_t playing;
+  std::uint8_t game_won;
+  std::uint8_t game_lose;
+  std::uint8_t padding[3];
+};
+
+/**
+ *  The whole shared memory segment.
+ *  The header is written once when the segment is created. The frame
+ *  is guarded by a sequence lock: the sequence is odd while the frame
+ *  is being written, so readers copy it out and retry if the sequence
+ *  was odd or changed while they copied.
+ */
+struct MetricsSegment
+{
+  std::uint32_t magic;
+  std::uint32_t version;
+  std::uint32_t size; /**< sizeof(MetricsSegment) in the writer. */
+  std::uint32_t reserved;
+  std::atomic<std::uint32_t> sequence;
+  std::uint32_t reserved_too;
+  MetricsFrame frame;
+};
+
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free,
+              "the sequence must be lock free to be shared between processes");
+
+/**
+ *  Publishes live metrics through POSIX shared memory.
+ *  Publishing copies one frame into the segment without locking or
+ *  making a system call, so external monitors cost the game nothing
+ *  and a monitor that stalls can never hold the game up. The segment
+ *  is removed when the publisher is destroyed.
+ *
+ *  Only Linux is supported. Elsewhere opening the segment fails.
+ */
+class SharedMetrics
+{
+ public:
+  static constexpr std::uint32_t MAGIC = 0x53494D31; /**< "SIM1" */
+  static constexpr std::uint32_t VERSION = 1;
+
+  SharedMetrics() = default;
+  ~SharedMetrics();
+
+  SharedMetrics(const SharedMetrics&) = delete;
+  SharedMetrics& operator=(const SharedMetrics&) = delete;
+
+  /**
+   *  Creates the segment, replacing any left by an earlier run.
+   *  @param [in] name The segment's name, such as "/space-invaders"
+   *  @return true if the segment was created
+   */
+  bool open(const std::string& name);
+
+  /**
+   *  Is the segment open?
+   *  @return true once open has succeeded
+   */
+  bool isOpen() const { return segment != nullptr; }
+
+  /**
+   *  Copies a frame into the segment.
+   *  Does nothing if the segment isn't open.
+   *  @param [in] frame The latest metrics
+   */
+  void publish(const MetricsFrame& frame);
+
+  /**
+   *  Copies a consistent frame out of a mapped segment.
+   *  Retries while the frame is being written.
+   *  @param [in] segment The segment mapped by a reader
+   *  @param [out] frame The latest metrics
+   *  @return false if the writer was always mid-frame
+   */
+  static bool read(const MetricsSegment& segment, MetricsFrame& frame);
+
+ private:
+  MetricsSegment* segment = nullptr;
+  std::string segment_name;
+};
@@ -0,0 +1,84 @@
+#include "SimulationThread.h"
+#include "Profiler.h"
+#include "SamplingProfiler.h"
+
+/**
+ *   @brief   Constructor.
+ *   @details The thread is started last, once everything it uses
+ *            has been constructed.
+ */
+SimulationThread::SimulationThread(std::function<void()> step_) :
+  step(std::move(step_)), thread(&SimulationThread::loop, this)
+{
+}
+
+/**
+ *   @brief   Destructor.
+ *   @details Lets the current step finish before stopping.
+ */
+SimulationThread::~SimulationThread()
+{
+  join();
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+
+  signal.notify_all();
+  thread.join();
+}
+
+/**
+ *   @brief   Starts a step on the simulation thread.
+ *   @return  void
+ */
+void SimulationThread::kick()
+{
+  join();
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    running = true;
+  }
+
+  signal.notify_all();
+}
+
+/**
+ *   @brief   Waits for the step in flight.
+ *   @return  void
+ */
+void SimulationThread::join()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  signal.wait(lock, [this] { return !running; });
+}
+
+/**
+ *   @brief   The simulation thread's main loop.
+ *   @details Sleeps until kicked, runs one step and reports back.
+ *   @return  void
+ */
+void SimulationThread::loop()
+{
+  Profiler::nameThread("simulation");
+  SamplingProfiler::registerThread();
+  std::unique_lock<std::mutex> lock(mutex);
+
+  while (true)
+  {
+    signal.wait(lock, [this] { return running || stopping; });
+    if (stopping)
+    {
+      return;
+    }
+
+    lock.unlock();
+    step();
+    lock.lock();
+
+    running = false;
+    signal.notify_all();
+  }
+}
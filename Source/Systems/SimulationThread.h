@@ -0,0 +1,49 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+ *  Runs the simulation one frame ahead of the renderer.
+ *  Each kick runs a single step on a dedicated thread, leaving the main
+ *  thread free to draw the previous step. Joining waits for the step in
+ *  flight, after which the simulation's state may safely be changed.
+ */
+class SimulationThread
+{
+ public:
+  /**
+   *  Constructor. Starts the thread.
+   *  @param [in] step Called on the thread once for every kick
+   */
+  explicit SimulationThread(std::function<void()> step);
+
+  /**
+   *  Destructor. Finishes the step in flight and joins the thread.
+   */
+  ~SimulationThread();
+
+  SimulationThread(const SimulationThread&) = delete;
+  SimulationThread& operator=(const SimulationThread&) = delete;
+
+  /**
+   *  Starts a step. Any step already in flight is finished first.
+   */
+  void kick();
+
+  /**
+   *  Waits for the step in flight, if there is one.
+   */
+  void join();
+
+ private:
+  void loop();
+
+  std::function<void()> step;
+  std::mutex mutex;
+  std::condition_variable signal;
+  bool running = false;
+  bool stopping = false;
+  std::thread thread;
+};
@@ -0,0 +1,88 @@
+#include "SpriteAnimator.h"
+#include <Engine/Sprite.h>
+#include <cmath>
+
+/**
+ *   @brief   Adds a frame to the atlas.
+ *   @details Frames are stored in the order they are added, so
+ *            animations are defined using consecutive frames.
+ *   @return  The index of the new frame.
+ */
+int SpriteAnimator::addFrame(const AtlasFrame& frame)
+{
+  frames.push_back(frame);
+  return static_cast<int>(frames.size()) - 1;
+}
+
+/**
+ *   @brief   Defines an animation.
+ *   @details The frames must already exist in the atlas. Each new
+ *            animation starts its clock at zero.
+ *   @return  The id of the animation, or -1 if it was rejected.
+ */
+int SpriteAnimator::addAnimation(int first_frame,
+                                 int frame_count,
+                                 float frames_per_second)
+{
+  if (first_frame < 0 || frame_count <= 0 || frames_per_second <= 0 ||
+      first_frame + frame_count > static_cast<int>(frames.size()))
+  {
+    return -1;
+  }
+
+  Animation animation;
+  animation.first_frame = first_frame;
+  animation.frame_count = frame_count;
+  animation.frame_ms = 1000.0 / frames_per_second;
+
+  animations.push_back(animation);
+  return static_cast<int>(animations.size()) - 1;
+}
+
+/**
+ *   @brief   Advances the animation clocks.
+ *   @details One clock per animation, not per entity. The clock
+ *            wraps at the length of the animation so it never loses
+ *            precision however long the game runs.
+ *   @return  void
+ */
+void SpriteAnimator::update(double delta_ms)
+{
+  for (auto& animation : animations)
+  {
+    double length_ms = animation.frame_ms * animation.frame_count;
+    animation.clock_ms = std::fmod(animation.clock_ms + delta_ms, length_ms);
+    animation.current_frame =
+      static_cast<int>(animation.clock_ms / animation.frame_ms);
+  }
+}
+
+/**
+ *   @brief   Finds an animation's current frame.
+ *   @details The animation's current frame, offset by the phase and
+ *            wrapped around the length of the animation.
+ *   @return  The index of the frame in the atlas.
+ */
+int SpriteAnimator::frameOf(int animation, int phase) const
+{
+  const Animation& playing = animations[static_cast<std::size_t>(animation)];
+  int offset = (playing.current_frame + phase) % playing.frame_count;
+  return playing.first_frame + offset;
+}
+
+/**
+ *   @brief   Applies an atlas frame to a sprite.
+ *   @details The frame's region is copied into the sprite's source
+ *            rectangle.
+ *   @return  void
+ */
+void SpriteAnimator::applyFrame(ASGE::Sprite& sprite, int frame) const
+{
+  const AtlasFrame& region = frames[static_cast<std::size_t>(frame)];
+
+  float* src_rect = sprite.srcRect();
+  src_rect[0] = region.x;
+  src_rect[1] = region.y;
+  src_rect[2] = region.width;
+  src_rect[3] = region.height;
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <vector>
+
+namespace ASGE
+{
+  class Sprite;
+}
+
+/**
+ *  A region of a texture atlas, measured in pixels.
+ */
+struct AtlasFrame
+{
+  float x = 0;
+  float y = 0;
+  float width = 0;
+  float height = 0;
+};
+
+/**
+ *  Plays sprite-sheet animations from a texture atlas.
+ *  An animation is a run of consecutive frames in the atlas. Every
+ *  animation owns a single clock which is shared by all the sprites
+ *  playing it, so advancing the animations costs the same regardless
+ *  of how many entities use them. Sprites are only touched when they
+ *  are drawn, when their source rectangle is set to the current frame.
+ */
+class SpriteAnimator
+{
+ public:
+  /**
+   *  Default constructor.
+   */
+  SpriteAnimator() = default;
+
+  /**
+   *  Adds a frame to the end of the atlas.
+   *  @param [in] frame The frame's region of the atlas texture
+   *  @return the index of the frame
+   */
+  int addFrame(const AtlasFrame& frame);
+
+  /**
+   *  Defines an animation over a range of atlas frames.
+   *  @param [in] first_frame The index of the animation's first frame
+   *  @param [in] frame_count The number of frames in the animation
+   *  @param [in] frames_per_second The playback rate
+   *  @return the id of the animation, or -1 if the range is invalid
+   */
+  int addAnimation(int first_frame, int frame_count, float frames_per_second);
+
+  /**
+   *  Advances every animation's clock.
+   *  @param [in] delta_ms The time since the last update in milliseconds
+   */
+  void update(double delta_ms);
+
+  /**
+   *  Finds the atlas frame an animation is currently showing.
+   *  Entities sharing a clock can be offset from each other using the
+   *  phase, so that they don't all animate in lockstep.
+   *  @param [in] animation The id of the animation being played
+   *  @param [in] phase How many frames ahead of the clock to display
+   *  @return the index of the atlas frame
+   */
+  int frameOf(int animation, int phase = 0) const;
+
+  /**
+   *  Sets a sprite's source rectangle to a frame of the atlas.
+   *  The atlas doesn't change once set up, so this is safe to call
+   *  whilst the clocks are being updated on another thread.
+   *  @param [in] sprite The sprite about to be drawn
+   *  @param [in] frame The index of the atlas frame
+   */
+  void applyFrame(ASGE::Sprite& sprite, int frame) const;
+
+ private:
+  struct Animation
+  {
+    int first_frame = 0;
+    int frame_count = 0;
+    double frame_ms = 0;
+    double clock_ms = 0;
+    int current_frame = 0;
+  };
+
+  std::vector<AtlasFrame> frames;
+  std::vector<Animation> animations;
+};
@@ -0,0 +1,190 @@
+#include "StartupProfiler.h"
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#  include <fstream>
+#  include <sstream>
+#  include <time.h>
+#  include <unistd.h>
+#endif
+
+namespace
+{
+  using clock = StartupProfiler::clock;
+
+  struct Stage
+  {
+    std::string name;
+    bool on_main = true;
+    clock::time_point start;
+    clock::time_point end;
+  };
+
+  /**
+   *  Works out when the process was launched on the steady clock.
+   *  The kernel gives the launch in clock ticks since boot, so the
+   *  time since launch is the time since boot less that, which is
+   *  then taken off the steady clock's time now.
+   */
+  clock::time_point launchTime(clock::time_point fallback)
+  {
+#ifdef __linux__
+    std::ifstream stat("/proc/self/stat");
+    std::string line;
+    std::getline(stat, line);
+
+    // the name may contain spaces, so fields are counted after it
+    std::size_t name_end = line.rfind(')');
+    if (name_end == std::string::npos)
+    {
+      return fallback;
+    }
+
+    // the start time is the 22nd field and the 3rd follows the name
+    std::istringstream fields(line.substr(name_end + 1));
+    std::string field;
+    for (int i = 3; i <= 22; ++i)
+    {
+      if (!(fields >> field))
+      {
+        return fallback;
+      }
+    }
+
+    long ticks = sysconf(_SC_CLK_TCK);
+    timespec boot{};
+    if (ticks <= 0 || clock_gettime(CLOCK_BOOTTIME, &boot) != 0)
+    {
+      return fallback;
+    }
+    clock::time_point now = clock::now();
+
+    double since_boot = double(boot.tv_sec) + double(boot.tv_nsec) * 1e-9;
+    double since_launch = since_boot - std::stod(field) / double(ticks);
+    if (since_launch < 0)
+    {
+      return fallback;
+    }
+
+    return now - std::chrono::duration_cast<clock::duration>(
+                   std::chrono::duration<double>(since_launch));
+#else
+    return fallback;
+#endif
+  }
+
+  std::mutex stage_mutex;
+  std::vector<Stage> stages;
+  clock::time_point presented{};
+
+  const std::thread::id main_thread = std::this_thread::get_id();
+  const clock::time_point loaded = clock::now();
+  const clock::time_point launched = launchTime(loaded);
+
+  double sinceLaunchMs(clock::time_point at)
+  {
+    return std::chrono::duration<double, std::milli>(at - launched).count();
+  }
+}
+
+/**
+ *   @brief   Records a stage that has finished
+ *   @details The first stage recorded is the time taken to load the
+ *            program, up to static initialisation.
+ *   @return  void
+ */
+void StartupProfiler::record(const std::string& name,
+                             clock::time_point start,
+                             clock::time_point end)
+{
+  bool on_main = std::this_thread::get_id() == main_thread;
+
+  std::lock_guard<std::mutex> lock(stage_mutex);
+  if (stages.empty())
+  {
+    stages.push_back({ "load program", true, launched, loaded });
+  }
+  stages.push_back({ name, on_main, start, end });
+}
+
+void StartupProfiler::mark(const std::string& name)
+{
+  clock::time_point now = clock::now();
+  record(name, now, now);
+}
+
+/**
+ *   @brief   Records the first frame being presented
+ *   @details Called every frame, so only the first call takes the
+ *            lock.
+ *   @return  void
+ */
+void StartupProfiler::firstFrame()
+{
+  static bool recorded = false;
+  if (recorded)
+  {
+    return;
+  }
+
+  recorded = true;
+  clock::time_point now = clock::now();
+  record("first frame presented", now, now);
+
+  std::lock_guard<std::mutex> lock(stage_mutex);
+  presented = now;
+}
+
+/**
+ *   @brief   Writes the start up report
+ *   @details Each stage's start and end are in milliseconds since the
+ *            process was launched. The launch is only known to the
+ *            nearest clock tick, usually 10ms.
+ *   @return  void
+ */
+void StartupProfiler::write(std::ostream& out)
+{
+  char line[128];
+  std::lock_guard<std::mutex> lock(stage_mutex);
+  if (presented != clock::time_point{})
+  {
+    std::snprintf(line,
+                  sizeof(line),
+                  "Startup: %.1fms to the first frame\n",
+                  sinceLaunchMs(presented));
+    out << line;
+  }
+  else
+  {
+    out << "Startup: the first frame was never presented\n";
+  }
+
+  std::snprintf(line,
+                sizeof(line),
+                "%-24s %-7s %10s %10s %10s\n",
+                "stage",
+                "thread",
+                "start_ms",
+                "end_ms",
+                "took_ms");
+  out << line;
+
+  for (const Stage& stage : stages)
+  {
+    std::snprintf(
+      line,
+      sizeof(line),
+      "%-24s %-7s %10.2f %10.2f %10.2f\n",
+      stage.name.c_str(),
+      stage.on_main ? "main" : "worker",
+      sinceLaunchMs(stage.start),
+      sinceLaunchMs(stage.end),
+      std::chrono::duration<double, std::milli>(stage.end - stage.start)
+        .count());
+    out << line;
+  }
+  out.flush();
+}
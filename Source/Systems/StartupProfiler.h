@@ -0,0 +1,71 @@
+#pragma once
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <utility>
+
+/**
+ *  Times each stage of starting up, from launch to the first frame.
+ *  Stages may run on any thread and overlap, and are kept in the order
+ *  they finish. Times are measured from when the process was launched,
+ *  as reported by the kernel, so time spent loading the executable and
+ *  its libraries before main is counted too. Elsewhere than Linux they
+ *  are measured from static initialisation.
+ */
+class StartupProfiler
+{
+ public:
+  using clock = std::chrono::steady_clock;
+
+  /**
+   *  Records a stage that has finished.
+   *  @param [in] name The stage's name
+   *  @param [in] start When the stage started
+   *  @param [in] end When the stage finished
+   */
+  static void record(const std::string& name,
+                     clock::time_point start,
+                     clock::time_point end);
+
+  /**
+   *  Records a moment, such as main being entered.
+   *  @param [in] name The moment's name
+   */
+  static void mark(const std::string& name);
+
+  /**
+   *  Records the first frame being presented, which ends start up.
+   *  Calls after the first are ignored.
+   */
+  static void firstFrame();
+
+  /**
+   *  Writes every stage in the order they finished.
+   *  @param [in] out The stream to write the report to
+   */
+  static void write(std::ostream& out);
+};
+
+/**
+ *  Records a stage of start up from construction to destruction.
+ */
+class StartupStage
+{
+ public:
+  explicit StartupStage(std::string name) :
+    name(std::move(name)), start(StartupProfiler::clock::now())
+  {
+  }
+
+  ~StartupStage()
+  {
+    StartupProfiler::record(name, start, StartupProfiler::clock::now());
+  }
+
+  StartupStage(const StartupStage&) = delete;
+  StartupStage& operator=(const StartupStage&) = delete;
+
+ private:
+  std::string name;
+  StartupProfiler::clock::time_point start;
+};
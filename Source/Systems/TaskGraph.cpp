@@ -0,0 +1,232 @@
+#include "TaskGraph.h"
+#include <Engine/DebugPrinter.h>
+#include <algorithm>
+
+namespace
+{
+  double toMs(TaskGraph::Clock::duration duration)
+  {
+    return std::chrono::duration<double, std::milli>(duration).count();
+  }
+}
+
+/**
+ *   @brief   Adds a task to the graph.
+ *   @details A task's ancestors are every task it depends upon,
+ *            directly or otherwise. They're kept as a bit mask so
+ *            checking whether two tasks are ordered is cheap. Every
+ *            dependency is checked before the graph is changed, so a
+ *            rejected task leaves no trace.
+ *   @return  The id of the new task, or -1 if it was rejected.
+ */
+int TaskGraph::addTask(const std::string& name,
+                       ResourceSet reads,
+                       ResourceSet writes,
+                       std::function<void()> work,
+                       std::initializer_list<int> after)
+{
+  int id = static_cast<int>(tasks.size());
+  if (id >= MAX_TASKS)
+  {
+    return -1;
+  }
+
+  for (int dependency : after)
+  {
+    if (dependency < 0 || dependency >= id)
+    {
+      return -1;
+    }
+  }
+
+  auto task = std::make_unique<Task>();
+  task->name = name;
+  task->phase = Profiler::phase(name);
+  task->reads = reads;
+  task->writes = writes;
+  task->work = std::move(work);
+
+  for (int dependency : after)
+  {
+    Task& parent = *tasks[static_cast<std::size_t>(dependency)];
+    parent.successors.push_back(id);
+    task->dependencies.push_back(dependency);
+    task->ancestors |= parent.ancestors | (std::uint64_t(1) << dependency);
+  }
+
+  tasks.push_back(std::move(task));
+  return id;
+}
+
+/**
+ *   @brief   Checks the declared resources for races.
+ *   @details Two tasks can only run at the same time if neither is
+ *            an ancestor of the other. Such pairs must not share a
+ *            resource that either of them writes.
+ *   @return  True if no conflicts were found.
+ */
+bool TaskGraph::validate() const
+{
+  bool valid = true;
+
+  for (std::size_t i = 0; i < tasks.size(); ++i)
+  {
+    for (std::size_t j = i + 1; j < tasks.size(); ++j)
+    {
+      const Task& first = *tasks[i];
+      const Task& second = *tasks[j];
+
+      if (second.ancestors & (std::uint64_t(1) << i))
+      {
+        continue;
+      }
+
+      ResourceSet shared = (first.writes & (second.reads | second.writes)) |
+                           (second.writes & first.reads);
+      if (shared)
+      {
+        ASGE::DebugPrinter{} << "Task graph conflict: " << first.name
+                             << " and " << second.name << " share resources "
+                             << shared << std::endl;
+        valid = false;
+      }
+    }
+  }
+
+  return valid;
+}
+
+/**
+ *   @brief   Runs the graph.
+ *   @details Tasks without dependencies are started straight away.
+ *            The rest are started by whichever task releases their
+ *            final dependency. The calling thread helps run tasks
+ *            until the whole graph is complete.
+ *   @return  void
+ */
+void TaskGraph::run(JobSystem& jobs)
+{
+  JobCounter counter;
+  runner.graph = this;
+  runner.jobs = &jobs;
+  runner.counter = &counter;
+
+  run_start = Clock::now();
+  for (auto& task : tasks)
+  {
+    task->remaining = static_cast<int>(task->dependencies.size());
+  }
+
+  for (std::size_t i = 0; i < tasks.size(); ++i)
+  {
+    if (tasks[i]->dependencies.empty())
+    {
+      jobs.schedule(counter, i, i + 1, 1, runner);
+    }
+  }
+
+  jobs.wait(counter);
+  run_end = Clock::now();
+
+  measure();
+}
+
+/**
+ *   @brief   Gets the critical path of the last run.
+ *   @return  The longest chain of dependent tasks in milliseconds.
+ */
+double TaskGraph::criticalPathMs() const
+{
+  return critical_path_ms;
+}
+
+/**
+ *   @brief   Gets the duration of the last run.
+ *   @return  The wall time in milliseconds.
+ */
+double TaskGraph::spanMs() const
+{
+  return toMs(run_end - run_start);
+}
+
+/**
+ *   @brief   Gets the number of tasks.
+ *   @return  The number of tasks in the graph.
+ */
+std::size_t TaskGraph::size() const
+{
+  return tasks.size();
+}
+
+/**
+ *   @brief   Gets a task's name.
+ *   @return  The task's name.
+ */
+const std::string& TaskGraph::taskName(std::size_t task) const
+{
+  return tasks[task]->name;
+}
+
+/**
+ *   @brief   Gets a task's duration in the last run.
+ *   @return  The time the task took in milliseconds.
+ */
+double TaskGraph::taskMs(std::size_t task) const
+{
+  return toMs(tasks[task]->end - tasks[task]->start);
+}
+
+/**
+ *   @brief   Runs a task and releases its successors.
+ *   @details A successor is scheduled by the task that finishes its
+ *            last dependency. It's counted against the graph before
+ *            this task completes, so the graph can't finish early.
+ *   @return  void
+ */
+void TaskGraph::Runner::operator()(std::size_t begin, std::size_t end)
+{
+  for (std::size_t i = begin; i < end; ++i)
+  {
+    Task& task = *graph->tasks[i];
+    task.start = Clock::now();
+    {
+      PROFILE_PHASE(task.phase);
+      task.work();
+    }
+    task.end = Clock::now();
+
+    for (int successor : task.successors)
+    {
+      auto index = static_cast<std::size_t>(successor);
+      if (--graph->tasks[index]->remaining == 0)
+      {
+        jobs->schedule(*counter, index, index + 1, 1, *this);
+      }
+    }
+  }
+}
+
+/**
+ *   @brief   Measures the critical path.
+ *   @details Tasks are stored in dependency order, so a single pass
+ *            finds the longest chain ending at each task. The chains
+ *            are kept between runs, so measuring doesn't allocate.
+ *   @return  void
+ */
+void TaskGraph::measure()
+{
+  longest.assign(tasks.size(), 0);
+  critical_path_ms = 0;
+
+  for (std::size_t i = 0; i < tasks.size(); ++i)
+  {
+    double before = 0;
+    for (int dependency : tasks[i]->dependencies)
+    {
+      before = std::max(before, longest[static_cast<std::size_t>(dependency)]);
+    }
+
+    longest[i] = before + toMs(tasks[i]->end - tasks[i]->start);
+    critical_path_ms = std::max(critical_path_ms, longest[i]);
+  }
+}
@@ -0,0 +1,136 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "JobSystem.h"
+#include "Profiler.h"
+
+/**
+ *  Describes a frame as a graph of dependent tasks.
+ *  Each task declares the resources it reads and writes, along with the
+ *  tasks it must run after. Tasks are started on the job system as soon
+ *  as everything they depend on has finished, so independent phases of
+ *  the frame overlap. Debug builds check that no two tasks which could
+ *  run at the same time touch the same resource unless both only read.
+ *  Every task is timed as a phase of the frame by the Profiler.
+ */
+class TaskGraph
+{
+ public:
+  using ResourceSet = std::uint32_t;
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr int MAX_TASKS = 64;
+
+  /**
+   *  Default constructor.
+   */
+  TaskGraph() = default;
+
+  /**
+   *  Adds a task to the graph.
+   *  Dependencies must already be in the graph, so tasks are always
+   *  added in an order that could be run on a single thread.
+   *  @param [in] name Used when reporting conflicts and timings
+   *  @param [in] reads The resources the task reads
+   *  @param [in] writes The resources the task modifies
+   *  @param [in] work The work the task performs
+   *  @param [in] after The ids of the tasks this one depends on
+   *  @return the id of the task, or -1 if it couldn't be added
+   */
+  int addTask(const std::string& name,
+              ResourceSet reads,
+              ResourceSet writes,
+              std::function<void()> work,
+              std::initializer_list<int> after = {});
+
+  /**
+   *  Checks the declared resources for races.
+   *  Any unordered pair of tasks that write a resource the other uses
+   *  is printed as a conflict.
+   *  @return true if the graph is free of conflicts
+   */
+  bool validate() const;
+
+  /**
+   *  Runs every task in the graph and waits for them to finish.
+   *  @param [in] jobs The job system used to run the tasks
+   */
+  void run(JobSystem& jobs);
+
+  /**
+   *  Gets the longest chain of dependent tasks in the last run.
+   *  This is the shortest the frame could take with unlimited threads.
+   *  @return the critical path length in milliseconds
+   */
+  double criticalPathMs() const;
+
+  /**
+   *  Gets the wall time taken by the last run.
+   *  @return the time from starting the graph to it finishing
+   */
+  double spanMs() const;
+
+  /**
+   *  Gets the number of tasks in the graph.
+   *  @return the number of tasks added
+   */
+  std::size_t size() const;
+
+  /**
+   *  Gets a task's name.
+   *  @param [in] task The id of the task
+   *  @return the name it was added with
+   */
+  const std::string& taskName(std::size_t task) const;
+
+  /**
+   *  Gets the time a task took in the last run.
+   *  @param [in] task The id of the task
+   *  @return the task's duration in milliseconds
+   */
+  double taskMs(std::size_t task) const;
+
+ private:
+  struct Task
+  {
+    std::string name;
+    ResourceSet reads = 0;
+    ResourceSet writes = 0;
+    std::function<void()> work;
+    std::vector<int> dependencies;
+    std::vector<int> successors;
+    std::uint64_t ancestors = 0;
+    std::atomic<int> remaining{ 0 };
+    int phase = -1; /**< The task's phase in the profiler. */
+    Clock::time_point start;
+    Clock::time_point end;
+  };
+
+  /**
+   *  Runs tasks from the job system and releases their successors.
+   */
+  struct Runner
+  {
+    TaskGraph* graph = nullptr;
+    JobSystem* jobs = nullptr;
+    JobCounter* counter = nullptr;
+
+    void operator()(std::size_t begin, std::size_t end);
+  };
+
+  void measure();
+
+  std::vector<std::unique_ptr<Task>> tasks;
+  Runner runner;
+  Clock::time_point run_start;
+  Clock::time_point run_end;
+  std::vector<double> longest; /**< Longest chain ending at each task. */
+  double critical_path_ms = 0;
+};
@@ -0,0 +1,154 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ *  Gives each thread a ring of its own from a fixed set of SIZE.
+ *  A thread claims a ring the first time it asks for one and keeps it
+ *  until it exits, when the ring is retired rather than freed. Its
+ *  reader recycles it once it has read everything left in it, and the
+ *  next thread to ask is handed it back, so threads that come and go,
+ *  such as input callbacks, reuse the same few rings. Rings are never
+ *  freed, so a reader may still look at one after its thread has gone.
+ *
+ *  Each ring type must have only one registry, as a thread's claim is
+ *  kept in a thread_local shared by every registry of that type.
+ */
+template<typename Ring, std::size_t SIZE>
+class ThreadRegistry
+{
+ public:
+  /**
+   *  Gets the calling thread's ring, claiming one on first use.
+   *  @return the ring, or nullptr if every ring is in use
+   */
+  Ring* local()
+  {
+    thread_local Owner owner;
+    if (!owner.claimed)
+    {
+      owner.claimed = true;
+      owner.slot = claim();
+    }
+
+    return owner.slot != nullptr ? owner.slot->ring.load() : nullptr;
+  }
+
+  /**
+   *  Visits every ring that is or was owned by a thread.
+   *  A ring seen as retired has had its last record written, so the
+   *  visitor can read all of it and then recycle it.
+   *  @param [in] visit Called with each ring and whether it's retired
+   */
+  template<typename Visitor>
+  void forEach(Visitor&& visit)
+  {
+    for (Slot& slot : slots)
+    {
+      std::uint8_t state = slot.state.load(std::memory_order_acquire);
+      Ring* ring = slot.ring.load(std::memory_order_acquire);
+      if (ring != nullptr && (state == OWNED || state == RETIRED))
+      {
+        visit(*ring, state == RETIRED);
+      }
+    }
+  }
+
+  /**
+   *  Hands a retired ring to the next thread that asks for one.
+   *  @param [in] ring A ring seen as retired by forEach
+   */
+  void recycle(Ring& ring)
+  {
+    for (Slot& slot : slots)
+    {
+      if (slot.ring.load(std::memory_order_relaxed) == &ring)
+      {
+        std::uint8_t retired = RETIRED;
+        slot.state.compare_exchange_strong(
+          retired, FREE, std::memory_order_release);
+        return;
+      }
+    }
+  }
+
+  /**
+   *  Gets a ring's fixed place in the registry.
+   *  @param [in] ring Any ring from this registry
+   *  @return its place, from 1 to SIZE
+   */
+  int id(const Ring& ring) const
+  {
+    for (std::size_t i = 0; i < SIZE; ++i)
+    {
+      if (slots[i].ring.load(std::memory_order_relaxed) == &ring)
+      {
+        return static_cast<int>(i) + 1;
+      }
+    }
+    return 0;
+  }
+
+ private:
+  enum State : std::uint8_t
+  {
+    UNUSED,
+    OWNED,
+    RETIRED,
+    FREE
+  };
+
+  struct Slot
+  {
+    std::atomic<Ring*> ring{ nullptr };
+    std::atomic<std::uint8_t> state{ UNUSED };
+  };
+
+  /**
+   *  Retires the thread's ring as the thread exits.
+   */
+  struct Owner
+  {
+    ~Owner()
+    {
+      if (slot != nullptr)
+      {
+        slot->state.store(RETIRED, std::memory_order_release);
+      }
+    }
+
+    Slot* slot = nullptr;
+    bool claimed = false;
+  };
+
+  Slot* claim()
+  {
+    // recycled rings first, so new ones are only made when needed
+    for (Slot& slot : slots)
+    {
+      std::uint8_t free = FREE;
+      if (slot.state.compare_exchange_strong(
+            free, OWNED, std::memory_order_acquire))
+      {
+        return &slot;
+      }
+    }
+
+    for (Slot& slot : slots)
+    {
+      std::uint8_t unused = UNUSED;
+      if (slot.state.compare_exchange_strong(
+            unused, OWNED, std::memory_order_acquire))
+      {
+        slot.ring.store(new Ring(), std::memory_order_release);
+        return &slot;
+      }
+    }
+
+    return nullptr;
+  }
+
+  std::array<Slot, SIZE> slots;
+};
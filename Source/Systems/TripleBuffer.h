@@ -0,0 +1,64 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ *  Hands values from one producer thread to one consumer thread.
+ *  The producer fills the back buffer and publishes it by swapping it
+ *  with the middle one. The consumer fetches by swapping the middle with
+ *  its front buffer. Neither side ever waits for the other, and the
+ *  consumer always sees the most recently published value in full.
+ */
+template<typename T>
+class TripleBuffer
+{
+ public:
+  /**
+   *  Gets the buffer the producer is filling.
+   *  @return the back buffer
+   */
+  T& writeBuffer() { return buffers[back]; }
+
+  /**
+   *  Publishes the back buffer to the consumer.
+   *  The producer is handed the old middle buffer to fill next, which
+   *  holds stale data and should be completely overwritten.
+   */
+  void publish()
+  {
+    std::uint8_t old = middle.exchange(static_cast<std::uint8_t>(back | FRESH),
+                                       std::memory_order_acq_rel);
+    back = old & INDEX;
+  }
+
+  /**
+   *  Takes the most recently published buffer, if there is a new one.
+   *  @return true if the front buffer changed
+   */
+  bool fetch()
+  {
+    if (!(middle.load(std::memory_order_relaxed) & FRESH))
+    {
+      return false;
+    }
+
+    front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+    return true;
+  }
+
+  /**
+   *  Gets the buffer the consumer is reading.
+   *  @return the front buffer
+   */
+  const T& readBuffer() const { return buffers[front]; }
+
+ private:
+  static constexpr std::uint8_t INDEX = 3;
+  static constexpr std::uint8_t FRESH = 4;
+
+  std::array<T, 3> buffers;
+  std::atomic<std::uint8_t> middle{ 1 };
+  std::uint8_t back = 0;
+  std::uint8_t front = 2;
+};
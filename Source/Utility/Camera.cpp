@@ -0,0 +1,101 @@
+#include "Camera.h"
+#include <algorithm>
+
+/**
+ *   @brief   Constructor.
+ *   @details Requires the size of the screen. The world defaults to
+ *            the same size, so the camera starts out fixed in place.
+ *   @return  void
+ */
+Camera::Camera(float width, float height)
+{
+  viewport.length = width;
+  viewport.height = height;
+  world = viewport;
+}
+
+/**
+ *   @brief   Sets the area the camera can scroll around.
+ *   @return  void
+ */
+void Camera::setWorldBounds(const rect& bounds)
+{
+  world = bounds;
+  clamp();
+}
+
+/**
+ *   @brief   Centres the camera on a point.
+ *   @details The point is given in world coordinates.
+ *   @return  void
+ */
+void Camera::lookAt(float x, float y)
+{
+  viewport.x = x - viewport.length / 2;
+  viewport.y = y - viewport.height / 2;
+  clamp();
+}
+
+/**
+ *   @brief   Moves the camera.
+ *   @return  void
+ */
+void Camera::scroll(float dx, float dy)
+{
+  viewport.x += dx;
+  viewport.y += dy;
+  clamp();
+}
+
+/**
+ *   @brief   Converts a world x coordinate into screen space.
+ *   @return  The screen coordinate.
+ */
+float Camera::toScreenX(float world_x) const
+{
+  return world_x - viewport.x;
+}
+
+/**
+ *   @brief   Converts a world y coordinate into screen space.
+ *   @return  The screen coordinate.
+ */
+float Camera::toScreenY(float world_y) const
+{
+  return world_y - viewport.y;
+}
+
+/**
+ *   @brief   Can the camera see an area of the world?
+ *   @details Used to cull objects, or whole groups of objects,
+ *            before they are submitted to the renderer.
+ *   @return  True if any part of the area is on screen.
+ */
+bool Camera::isVisible(const rect& world_bounds) const
+{
+  return viewport.isInside(world_bounds);
+}
+
+/**
+ *   @brief   Gets the visible area of the world.
+ *   @return  The camera's rectangle in world coordinates.
+ */
+const rect& Camera::view() const
+{
+  return viewport;
+}
+
+/**
+ *   @brief   Keeps the camera inside the world.
+ *   @details Worlds smaller than the screen are aligned to the
+ *            top left corner.
+ *   @return  void
+ */
+void Camera::clamp()
+{
+  float max_x = world.x + world.length - viewport.length;
+  float max_y = world.y + world.height - viewport.height;
+
+  viewport.x = std::max(world.x, std::min(viewport.x, max_x));
+  viewport.y = std::max(world.y, std::min(viewport.y, max_y));
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "Rect.h"
+
+/**
+ *  A 2D camera looking onto the playfield.
+ *  The playfield can be larger than the screen, so game objects are
+ *  positioned in world coordinates and translated into screen space
+ *  when drawn. The camera never leaves the bounds of the world.
+ */
+class Camera
+{
+ public:
+  /**
+   *  Constructor.
+   *  @param [in] width The width of the screen in pixels
+   *  @param [in] height The height of the screen in pixels
+   */
+  Camera(float width, float height);
+
+  void setWorldBounds(const rect& bounds);
+  void lookAt(float x, float y);
+  void scroll(float dx, float dy);
+
+  float toScreenX(float world_x) const;
+  float toScreenY(float world_y) const;
+  bool isVisible(const rect& world_bounds) const;
+  const rect& view() const;
+
+ private:
+  void clamp();
+
+  rect viewport;
+  rect world;
+};
@@ -1,15 +1,74 @@
 #include "Game.h"
+#include "GameSettings.h"
+#include "Systems/PerfCounters.h"
+#include "Systems/SamplingProfiler.h"
+#include "Systems/StartupProfiler.h"
+#include <fstream>
 #include <iostream>
-int main()
+int main(int argc, char* argv[])
 {
-  SpaceInvadersGame game;
+  StartupProfiler::mark("main");
+
+  // sampling starts first so every worker thread is registered
+  GameSettings settings = GameSettings::fromArgs(argc, argv);
+  if (!settings.sample_file.empty())
+  {
+    SamplingProfiler::start(settings.sample_hz);
+  }
+
+  auto constructing = StartupProfiler::clock::now();
+  SpaceInvadersGame game(settings);
+  StartupProfiler::record(
+    "construct game", constructing, StartupProfiler::clock::now());
+
   if (!game.init())
   {
     return -1;
   }
 
   game.run();
+  SamplingProfiler::stop(settings.sample_file);
+
+  const PacingStats& pacing = game.pacingStats();
+  std::cout << "Frame pacing: " << pacing.frames << " frames, "
+            << pacing.missed << " missed, mean jitter "
+            << pacing.mean_jitter_us << "us, max jitter "
+            << pacing.max_jitter_us << "us" << std::endl;
+
+  const LatencyTracker& latency = game.inputLatency();
+  for (int i = 0; i < LatencyTracker::STAGE_COUNT; ++i)
+  {
+    auto stage = static_cast<LatencyTracker::Stage>(i);
+    LatencyStats stats = latency.stats(stage);
+    std::cout << "Input latency (" << LatencyTracker::stageName(stage)
+              << "): " << stats.events << " events, " << stats.left_out
+              << " left out, p50 " << stats.p50_us << "us, p99 " << stats.p99_us
+              << "us, max " << stats.max_us << "us" << std::endl;
+  }
+
+  for (const CounterStats& phase : PerfCounters::summary())
+  {
+    std::cout << "Hardware counters (" << phase.name << "): " << phase.runs
+              << " runs, IPC " << phase.ipc() << ", per entity L1 misses "
+              << phase.perEntity(phase.l1_misses) << ", LLC misses "
+              << phase.perEntity(phase.llc_misses) << ", branch misses "
+              << phase.perEntity(phase.branch_misses) << std::endl;
+  }
+
+  game.sessionTelemetry().write(std::cout, settings.target_fps);
+  if (!settings.report_file.empty())
+  {
+    std::ofstream report(settings.report_file);
+    game.sessionTelemetry().write(report, settings.target_fps);
+  }
+
+  StartupProfiler::write(std::cout);
+  if (!settings.startup_report.empty())
+  {
+    std::ofstream report(settings.startup_report);
+    StartupProfiler::write(report);
+  }
 
   std::cout << "Exiting Game!" << std::endl;
   return 0;
-}
\ No newline at end of file
+}